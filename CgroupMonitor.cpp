@@ -0,0 +1,257 @@
+#include "CgroupMonitor.h"
+#include <QDebug>
+#include <QFile>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+// Reads a whole cgroup file into buffer and NUL terminates it, returns the byte count or -1
+ssize_t readFile(int dirFd, const char *name, char *buffer, std::size_t size)
+{
+    const int fd = openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    std::size_t total = 0;
+    while (total < size - 1) {
+        const ssize_t n = ::read(fd, buffer + total, size - 1 - total);
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+    }
+    ::close(fd);
+    buffer[total] = '\0';
+    return static_cast<ssize_t>(total);
+}
+
+// Value of "key value" in a flat keyed file such as cpu.stat or memory.stat, 0 if absent
+quint64 keyedValue(const char *data, const char *key)
+{
+    const std::size_t keyLength = strlen(key);
+    for (const char *line = data; *line != '\0';) {
+        if (strncmp(line, key, keyLength) == 0 && line[keyLength] == ' ') {
+            return strtoull(line + keyLength + 1, nullptr, 10);
+        }
+        const char *next = strchr(line, '\n');
+        if (!next) {
+            break;
+        }
+        line = next + 1;
+    }
+    return 0;
+}
+
+// Sum of "key=value" over every line, for io.stat's one line per device
+quint64 sumNestedValue(const char *data, const char *key)
+{
+    const std::size_t keyLength = strlen(key);
+    quint64 total = 0;
+    for (const char *pos = data; (pos = strstr(pos, key)) != nullptr; pos += keyLength) {
+        if ((pos == data || pos[-1] == ' ') && pos[keyLength] == '=') {
+            total += strtoull(pos + keyLength + 1, nullptr, 10);
+        }
+    }
+    return total;
+}
+} // namespace
+
+CgroupMonitor::CgroupMonitor(QObject *parent)
+    : QObject(parent)
+    , m_rootFd(-1)
+    , m_procFd(::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+    , m_processesChanged(false)
+    , m_generation(0)
+    , m_processors(sysconf(_SC_NPROCESSORS_ONLN))
+{
+    const QString mount = findMount();
+    if (!mount.isEmpty()) {
+        m_rootFd = ::open(QFile::encodeName(mount).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+    if (m_rootFd < 0) {
+        qWarning() << "No cgroup2 hierarchy mounted";
+    }
+
+    sample(SampleTick::now());
+}
+
+CgroupMonitor::~CgroupMonitor()
+{
+    if (m_rootFd >= 0) {
+        ::close(m_rootFd);
+    }
+    if (m_procFd >= 0) {
+        ::close(m_procFd);
+    }
+}
+
+void CgroupMonitor::setProcesses(const QVector<ProcessIdentity> &processes)
+{
+    m_processes = processes;
+    m_processesChanged = true;
+}
+
+QString CgroupMonitor::findMount()
+{
+    // Usually /sys/fs/cgroup, /sys/fs/cgroup/unified on hybrid v1/v2 systems
+    QFile file("/proc/self/mounts");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.split(' ');
+        if (fields.size() >= 3 && fields[2] == "cgroup2") {
+            return QFile::decodeName(fields[1]);
+        }
+    }
+    return QString();
+}
+
+void CgroupMonitor::mapProcesses()
+{
+    // The start time tells a reused PID apart, cgroup is read only for new ones
+    m_members.clear();
+
+    for (const ProcessIdentity &process : std::as_const(m_processes)) {
+        const ProcessKey key{process.pid, process.startTime};
+        auto it = m_pidCgroups.find(key);
+        if (it == m_pidCgroups.end()) {
+            // 0::/user.slice/... is the unified hierarchy, v1 controller lines are ignored
+            CachedCgroup cached{QString(), 0};
+            char path[32];
+            snprintf(path, sizeof(path), "%d/cgroup", process.pid);
+            if (m_procFd >= 0 && readFile(m_procFd, path, m_buffer, sizeof(m_buffer)) > 0) {
+                const char *line = strncmp(m_buffer, "0::", 3) == 0 ? m_buffer : strstr(m_buffer, "\n0::");
+                if (line) {
+                    line += *line == '\n' ? 4 : 3;
+                    cached.path = QString::fromUtf8(line, static_cast<int>(strcspn(line, "\n")));
+                }
+            }
+            it = m_pidCgroups.insert(key, cached);
+        }
+        it->generation = m_generation;
+        if (!it->path.isEmpty()) {
+            m_members[it->path].append(CgroupProcess{process.pid, process.name});
+        }
+    }
+
+    // Exited processes drop out of the cache
+    for (auto it = m_pidCgroups.begin(); it != m_pidCgroups.end();) {
+        if (it->generation != m_generation) {
+            it = m_pidCgroups.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void CgroupMonitor::readCgroup(int dirFd, CgroupUsage &usage, CgroupCounters &counters)
+{
+    // Each counter is stamped when its file was read, the walk can take a while on big hierarchies
+    const quint64 usageUsec = readFile(dirFd, "cpu.stat", m_buffer, sizeof(m_buffer)) > 0
+                                  ? keyedValue(m_buffer, "usage_usec")
+                                  : 0;
+    const double usageUsecRate = counters.usageUsec.update(usageUsec, CounterRate::nowNs());
+    usage.cpuUsage = usageUsecRate / 1e6 / m_processors * 100;
+
+    usage.memoryMB = readFile(dirFd, "memory.current", m_buffer, sizeof(m_buffer)) > 0
+                         ? strtoull(m_buffer, nullptr, 10) / (1024.0 * 1024.0)
+                         : 0.0;
+    usage.anonMB = 0.0;
+    usage.fileMB = 0.0;
+    if (readFile(dirFd, "memory.stat", m_buffer, sizeof(m_buffer)) > 0) {
+        usage.anonMB = keyedValue(m_buffer, "anon") / (1024.0 * 1024.0);
+        usage.fileMB = keyedValue(m_buffer, "file") / (1024.0 * 1024.0);
+    }
+
+    quint64 readBytes = 0;
+    quint64 writeBytes = 0;
+    if (readFile(dirFd, "io.stat", m_buffer, sizeof(m_buffer)) > 0) {
+        readBytes = sumNestedValue(m_buffer, "rbytes");
+        writeBytes = sumNestedValue(m_buffer, "wbytes");
+    }
+    const qint64 ioReadNs = CounterRate::nowNs();
+    usage.readRate = counters.readBytes.update(readBytes, ioReadNs);
+    usage.writeRate = counters.writeBytes.update(writeBytes, ioReadNs);
+
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    usage.cpuPressure = 0.0;
+    if (readFile(dirFd, "cpu.pressure", m_buffer, sizeof(m_buffer)) > 0) {
+        const char *avg10 = strstr(m_buffer, "avg10=");
+        if (avg10) {
+            usage.cpuPressure = strtod(avg10 + 6, nullptr);
+        }
+    }
+}
+
+void CgroupMonitor::walk(int dirFd, const QString &path, const QString &parentPath)
+{
+    CgroupUsage usage;
+    usage.path = path;
+    usage.parentPath = parentPath;
+    usage.processes = m_members.value(path);
+
+    // A cgroup removed and recreated under the same name shows up as a counter reset
+    CgroupCounters &counters = m_counters[path];
+    counters.generation = m_generation;
+    readCgroup(dirFd, usage, counters);
+    m_cgroups.append(usage);
+
+    // fdopendir takes ownership of the descriptor it is given
+    const int listFd = dup(dirFd);
+    DIR *dir = listFd >= 0 ? fdopendir(listFd) : nullptr;
+    if (!dir) {
+        if (listFd >= 0) {
+            ::close(listFd);
+        }
+        return;
+    }
+    // The duplicate shares the file offset, which the previous walk left at the end
+    rewinddir(dir);
+    while (const dirent *entry = readdir(dir)) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') {
+            continue;
+        }
+        const int childFd = openat(dirFd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (childFd < 0) {
+            continue;
+        }
+        const QString name = QString::fromUtf8(entry->d_name);
+        walk(childFd, path == "/" ? "/" + name : path + "/" + name, path);
+        ::close(childFd);
+    }
+    closedir(dir);
+}
+
+void CgroupMonitor::sample(const SampleTick &tick)
+{
+    if (m_rootFd < 0) {
+        return;
+    }
+
+    ++m_generation;
+    // Memberships only change with the process list, moves between cgroups are not tracked
+    if (m_processesChanged) {
+        mapProcesses();
+        m_processesChanged = false;
+    }
+
+    m_cgroups.clear();
+    walk(m_rootFd, "/", QString());
+
+    // Removed cgroups
+    for (auto it = m_counters.begin(); it != m_counters.end();) {
+        if (it->generation != m_generation) {
+            it = m_counters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    emit cgroupsUpdated(m_cgroups, tick);
+}
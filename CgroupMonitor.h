@@ -0,0 +1,110 @@
+#ifndef CGROUPMONITOR_H
+#define CGROUPMONITOR_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "CounterRate.h"
+#include "ProcessInfo.h"
+#include "SampleScheduler.h"
+
+// A process placed in its cgroup through /proc/<pid>/cgroup
+struct CgroupProcess
+{
+    int pid;
+    QString name;
+};
+
+// One cgroup v2 directory with rates over the interval since the previous sample
+struct CgroupUsage
+{
+    QString path;        // relative to the cgroup2 mount, "/" for the root
+    QString parentPath;  // empty for the root
+    double cpuUsage;     // cpu.stat usage_usec, percent of all CPUs like ProcessUsage
+    double memoryMB;     // memory.current, 0 where the memory controller is off (and at the root)
+    double anonMB;       // memory.stat anon and file
+    double fileMB;
+    double readRate;     // io.stat rbytes/wbytes summed over devices, bytes per second
+    double writeRate;
+    double cpuPressure;  // cpu.pressure some avg10 in percent
+    QVector<CgroupProcess> processes; // directly in this cgroup, not its descendants
+};
+
+// Walks the cgroup2 hierarchy and reads the accounting files of every cgroup. Processes come
+// from ProcessInfo's scan through setProcesses and are mapped to cgroups through
+// /proc/<pid>/cgroup, which is read once per (pid, starttime) and cached until that PID goes
+// away or is reused.
+class CgroupMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CgroupMonitor(QObject *parent = nullptr);
+    ~CgroupMonitor();
+
+    // False when no cgroup2 hierarchy is mounted
+    bool isAvailable() const { return m_rootFd >= 0; }
+
+    void sample(const SampleTick &tick);
+
+public slots:
+    // Connect to ProcessInfo::processListChanged, the mapping is redone on the next sample
+    void setProcesses(const QVector<ProcessIdentity> &processes);
+
+signals:
+    // Parents always come before their children
+    void cgroupsUpdated(const QVector<CgroupUsage> &cgroups, const SampleTick &tick);
+
+private:
+    static const std::size_t BufferSize = 16384;
+
+    struct ProcessKey
+    {
+        int pid;
+        quint64 startTime;
+
+        bool operator==(const ProcessKey &other) const
+        {
+            return pid == other.pid && startTime == other.startTime;
+        }
+    };
+    friend size_t qHash(const ProcessKey &key, size_t seed)
+    {
+        return qHashMulti(seed, key.pid, key.startTime);
+    }
+
+    struct CachedCgroup
+    {
+        QString path;
+        quint64 generation; // last sample the process was listed in
+    };
+
+    // cpu.stat usage_usec and the io.stat byte totals, kept across samples to turn into rates
+    struct CgroupCounters
+    {
+        CounterRate usageUsec;
+        CounterRate readBytes;
+        CounterRate writeBytes;
+        quint64 generation = 0;
+    };
+
+    static QString findMount();
+    void mapProcesses();
+    void walk(int dirFd, const QString &path, const QString &parentPath);
+    void readCgroup(int dirFd, CgroupUsage &usage, CgroupCounters &counters);
+
+    int m_rootFd;
+    int m_procFd;
+    QVector<ProcessIdentity> m_processes;
+    bool m_processesChanged;
+    QHash<ProcessKey, CachedCgroup> m_pidCgroups;
+    QHash<QString, QVector<CgroupProcess>> m_members;
+    QHash<QString, CgroupCounters> m_counters;
+    QVector<CgroupUsage> m_cgroups;
+    quint64 m_generation;
+    long m_processors;
+    char m_buffer[BufferSize];
+};
+
+#endif // CGROUPMONITOR_H
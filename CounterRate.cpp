@@ -0,0 +1,77 @@
+#include "CounterRate.h"
+#include <time.h>
+
+CounterRate::CounterRate(int bits)
+    : m_mask(bits >= 64 ? ~quint64(0) : (quint64(1) << bits) - 1)
+    , m_value(0)
+    , m_lastNs(0)
+    , m_delta(0)
+    , m_elapsed(0.0)
+    , m_rate(0.0)
+    , m_haveValue(false)
+    , m_valid(false)
+{
+}
+
+qint64 CounterRate::nowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+QString CounterRate::formatRate(double bytesPerSecond)
+{
+    if (bytesPerSecond >= 1024.0 * 1024.0) {
+        return QString::number(bytesPerSecond / (1024.0 * 1024.0), 'f', 1) + " MB/s";
+    }
+    if (bytesPerSecond >= 1024.0) {
+        return QString::number(bytesPerSecond / 1024.0, 'f', 1) + " KB/s";
+    }
+    return QString::number(bytesPerSecond, 'f', 0) + " B/s";
+}
+
+void CounterRate::reset()
+{
+    m_haveValue = false;
+    m_valid = false;
+    m_delta = 0;
+    m_elapsed = 0.0;
+    m_rate = 0.0;
+}
+
+double CounterRate::update(quint64 value, qint64 monotonicNs)
+{
+    value &= m_mask;
+    m_delta = 0;
+    m_rate = 0.0;
+    m_valid = false;
+    m_elapsed = m_haveValue ? (monotonicNs - m_lastNs) / 1e9 : 0.0;
+
+    // A second reading at the same instant keeps the older baseline
+    if (m_haveValue && m_elapsed <= 0.0) {
+        return 0.0;
+    }
+
+    if (m_haveValue) {
+        if (value >= m_value) {
+            m_delta = value - m_value;
+            m_valid = true;
+        } else {
+            // A real wrap moves the counter by less than half its range within one interval
+            const quint64 wrapped = (m_mask - m_value) + value + 1;
+            if (m_mask != ~quint64(0) && wrapped <= m_mask / 2) {
+                m_delta = wrapped;
+                m_valid = true;
+            }
+        }
+        if (m_valid) {
+            m_rate = m_delta / m_elapsed;
+        }
+    }
+
+    m_value = value;
+    m_lastNs = monotonicNs;
+    m_haveValue = true;
+    return m_rate;
+}
@@ -0,0 +1,50 @@
+#ifndef COUNTERRATE_H
+#define COUNTERRATE_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Turns a cumulative kernel counter into a per-second rate over the measured monotonic interval.
+// Counters narrower than 64 bits (the tick fields of diskstats, some NIC drivers) wrap and are
+// carried across the wrap. A counter that goes backwards by more than a plausible wrap was reset,
+// e.g. a device removed and re-added under the same name, and starts a new baseline instead of
+// producing a huge spike.
+class CounterRate
+{
+public:
+    explicit CounterRate(int bits = 64);
+
+    // Feeds the current reading, returns the rate since the previous one. 0 for the first
+    // reading, after a reset and when no time passed.
+    double update(quint64 value, qint64 monotonicNs);
+
+    // Increase over the last update, 0 when update returned 0 for lack of a baseline
+    quint64 delta() const { return m_delta; }
+    // Seconds covered by the last update
+    double elapsed() const { return m_elapsed; }
+    double rate() const { return m_rate; }
+    quint64 value() const { return m_value; }
+    bool hasBaseline() const { return m_valid; }
+
+    // Forgets the baseline, the next update starts over
+    void reset();
+
+    // CLOCK_MONOTONIC in ns. Take it right after reading the counters, not from the tick, so a
+    // late wakeup or a slow read does not skew the interval.
+    static qint64 nowNs();
+
+    // Byte rate for display, "1.5 MB/s", "12.0 KB/s" or "512 B/s"
+    static QString formatRate(double bytesPerSecond);
+
+private:
+    quint64 m_mask;  // largest value the counter can hold
+    quint64 m_value;
+    qint64 m_lastNs;
+    quint64 m_delta;
+    double m_elapsed;
+    double m_rate;
+    bool m_haveValue;
+    bool m_valid;
+};
+
+#endif // COUNTERRATE_H
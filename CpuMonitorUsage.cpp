@@ -1,39 +1,39 @@
 #include "CpuMonitorUsage.h"
-#include <QDir>
 #include <QFile>
-#include <QProcess>
-#include <QRegularExpression>
 #include <QTextStream>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 
 CpuMonitorUsage::CpuMonitorUsage(QObject *parent)
     : QObject(parent)
     , m_currentUsage(0.0)
-    , m_lastTotal(0)
-    , m_lastIdle(0)
+    , m_lastTimes()
     , m_firstRun(true)
+    , m_haveProcessTotals(false)
 {
     // Initialize history with 60 zeros for smooth graph start
-    m_utilizationHistory.fill(0, 60);
+    m_utilizationHistory = RingBuffer<double>(60, 0.0);
 
     // Initialize CPU info struct - only working fields
     m_cpuInfo.usage = 0.0;
+    m_cpuInfo.userPercent = m_cpuInfo.nicePercent = m_cpuInfo.systemPercent = 0.0;
+    m_cpuInfo.idlePercent = m_cpuInfo.iowaitPercent = m_cpuInfo.irqPercent = 0.0;
+    m_cpuInfo.softirqPercent = m_cpuInfo.stealPercent = 0.0;
+    m_cpuInfo.guestPercent = m_cpuInfo.guestNicePercent = 0.0;
+    m_cpuInfo.hasBreakdown = false;
     m_cpuInfo.sockets = 0;
     m_cpuInfo.coresPerSocket = 0;
     m_cpuInfo.logicalProcessors = 0;
+    m_cpuInfo.threadsPerCore = 0;
+    m_cpuInfo.numaNodes = 0;
     m_cpuInfo.processes = 0;
     m_cpuInfo.threads = 0;
+    m_cpuInfo.procsRunning = 0;
+    m_cpuInfo.procsBlocked = 0;
+    m_cpuInfo.loadAverage[0] = m_cpuInfo.loadAverage[1] = m_cpuInfo.loadAverage[2] = 0.0;
 
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this, &CpuMonitorUsage::updateCpuUsage);
-    m_timer->start(1000);
-
-    // Get initial detailed info immediately
-    updateDetailedInfo();
-    emit cpuInfoUpdated(m_cpuInfo);
-
-    // Start CPU usage updates
-    QTimer::singleShot(100, this, &CpuMonitorUsage::updateCpuUsage);
+    // Baseline sample so the first scheduler tick already has a delta
+    sample(SampleTick::now());
 }
 
 QString CpuMonitorUsage::getUsageString() const
@@ -41,160 +41,268 @@ QString CpuMonitorUsage::getUsageString() const
     return QString("CPU Usage: %1%").arg(QString::number(m_currentUsage, 'f', 1));
 }
 
-void CpuMonitorUsage::updateCpuUsage()
+void CpuMonitorUsage::resizeCores(int count)
+{
+    m_lastCoreTimes.resize(count);
+    m_coreUsages.resize(count);
+}
+
+quint64 CpuMonitorUsage::CpuTimes::total() const
+{
+    return fields[User] + fields[Nice] + fields[System] + fields[Idle] + fields[IoWait] + fields[Irq]
+           + fields[SoftIrq] + fields[Steal];
+}
+
+namespace {
+// Reads "cpu[N] user nice system idle iowait irq softirq steal guest guest_nice" starting at line,
+// returns false if it isn't a cpu line. core is -1 for the aggregate line. Columns missing on
+// older kernels are left at zero.
+bool parseCpuLine(const char *line, const char *end, int &core, quint64 *fields, int fieldCount)
+{
+    if (end - line < 4 || qstrncmp(line, "cpu", 3) != 0) {
+        return false;
+    }
+
+    const char *p = line + 3;
+    core = -1;
+    if (*p >= '0' && *p <= '9') {
+        core = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            core = core * 10 + (*p - '0');
+            ++p;
+        }
+    }
+
+    std::fill(fields, fields + fieldCount, 0);
+    for (int i = 0; i < fieldCount; ++i) {
+        while (p < end && *p == ' ') {
+            ++p;
+        }
+        if (p >= end || *p < '0' || *p > '9') {
+            // user nice system idle are always present
+            return i >= 4;
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            fields[i] = fields[i] * 10 + static_cast<quint64>(*p - '0');
+            ++p;
+        }
+    }
+    return true;
+}
+
+double usageBetween(quint64 lastTotal, quint64 lastIdle, quint64 total, quint64 idle)
+{
+    const quint64 diffTotal = total - lastTotal;
+    const quint64 diffIdle = idle - lastIdle;
+    if (total <= lastTotal || diffIdle > diffTotal) {
+        return 0.0;
+    }
+    return 100.0 * static_cast<double>(diffTotal - diffIdle) / static_cast<double>(diffTotal);
+}
+
+// Value of a "key N" line, e.g. "procs_running 3"
+bool parseCounterLine(const char *line, const char *end, const char *key, int &value)
 {
-    static const QRegularExpression whitespaceRegex("\\s+");
+    const int keyLength = static_cast<int>(qstrlen(key));
+    if (end - line <= keyLength || qstrncmp(line, key, keyLength) != 0 || line[keyLength] != ' ') {
+        return false;
+    }
+
+    value = 0;
+    for (const char *p = line + keyLength + 1; p < end && *p >= '0' && *p <= '9'; ++p) {
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+} // namespace
 
+void CpuMonitorUsage::sample(const SampleTick &tick)
+{
     QFile file("/proc/stat");
     if (!file.open(QIODevice::ReadOnly)) {
         return;
     }
 
-    QTextStream in(&file);
-    QStringList values = in.readLine().split(whitespaceRegex, Qt::SkipEmptyParts);
+    // Single read of the whole file, the aggregate and every cpuN line are parsed in one pass
+    const QByteArray content = file.readAll();
     file.close();
 
-    if (values.size() < 5) {
+    CpuTimes times;
+    bool haveAggregate = false;
+    QVector<CpuTimes> coreTimes;
+    coreTimes.reserve(m_lastCoreTimes.size());
+    QVector<int> coreIds;
+    coreIds.reserve(m_lastCoreTimes.size());
+
+    const char *pos = content.constData();
+    const char *end = pos + content.size();
+    while (pos < end) {
+        const char *lineEnd = static_cast<const char *>(memchr(pos, '\n', end - pos));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+
+        int core;
+        CpuTimes lineTimes;
+        if (parseCpuLine(pos, lineEnd, core, lineTimes.fields, CpuTimes::FieldCount)) {
+            if (core < 0) {
+                times = lineTimes;
+                haveAggregate = true;
+            } else {
+                coreIds.append(core);
+                coreTimes.append(lineTimes);
+            }
+        } else if (parseCounterLine(pos, lineEnd, "procs_running", m_cpuInfo.procsRunning)) {
+            // procs_blocked follows on the next line
+        } else if (parseCounterLine(pos, lineEnd, "procs_blocked", m_cpuInfo.procsBlocked)) {
+            // Last line we care about, skip the softirq table after it
+            break;
+        }
+
+        pos = lineEnd + 1;
+    }
+
+    if (!haveAggregate) {
         return;
     }
 
-    const quint64 user = values[1].toULongLong();
-    const quint64 nice = values[2].toULongLong();
-    const quint64 system = values[3].toULongLong();
-    const quint64 idle = values[4].toULongLong();
-    const quint64 total = user + nice + system + idle;
+    // Offline cores are missing from /proc/stat, so size by the highest id seen
+    int coreCount = 0;
+    for (int id : coreIds) {
+        coreCount = qMax(coreCount, id + 1);
+    }
+    const bool coresChanged = coreCount != m_coreUsages.size();
+    if (coresChanged) {
+        resizeCores(coreCount);
+    }
 
     if (!m_firstRun) {
-        const quint64 diffIdle = idle - m_lastIdle;
-        const quint64 diffTotal = total - m_lastTotal;
-
-        if (diffTotal > 0) {
-            m_currentUsage = 100.0 * static_cast<double>(diffTotal - diffIdle)
-                             / static_cast<double>(diffTotal);
-        }
+        m_currentUsage = usageBetween(m_lastTimes.total(), m_lastTimes.idle(), times.total(), times.idle());
 
         // Update CPU info struct
         m_cpuInfo.usage = m_currentUsage;
+        updateBreakdown(times);
 
         // Update utilization history (keep last 60 values)
-        if (m_utilizationHistory.size() >= 60) {
-            m_utilizationHistory.removeFirst();
-        }
-        m_utilizationHistory.append(m_currentUsage);
+        m_utilizationHistory.push(m_currentUsage);
 
         emit usageUpdated(m_currentUsage);
     } else {
         m_cpuInfo.usage = 0.0;
     }
 
+    m_coreUsages.fill(0.0);
+    for (int i = 0; i < coreIds.size(); ++i) {
+        const int id = coreIds[i];
+        if (!m_firstRun && !coresChanged) {
+            const CpuTimes &last = m_lastCoreTimes[id];
+            m_coreUsages[id] = usageBetween(last.total(),
+                                            last.idle(),
+                                            coreTimes[i].total(),
+                                            coreTimes[i].idle());
+        }
+        m_lastCoreTimes[id] = coreTimes[i];
+    }
+
+    if (!m_firstRun) {
+        emit perCoreUsageUpdated(m_coreUsages);
+    }
+
     // Update detailed CPU information every second
     updateDetailedInfo();
 
     // Emit detailed info signal
+    m_cpuInfo.hasBreakdown = !m_firstRun;
+    m_cpuInfo.tick = tick;
     emit cpuInfoUpdated(m_cpuInfo);
 
-    m_lastTotal = total;
-    m_lastIdle = idle;
+    m_lastTimes = times;
     m_firstRun = false;
 }
 
+void CpuMonitorUsage::updateBreakdown(const CpuTimes &times)
+{
+    const quint64 diffTotal = times.total() - m_lastTimes.total();
+    if (times.total() <= m_lastTimes.total()) {
+        return;
+    }
+
+    auto percent = [&](CpuTimes::Field field) {
+        if (times.fields[field] < m_lastTimes.fields[field]) {
+            return 0.0;
+        }
+        return 100.0 * static_cast<double>(times.fields[field] - m_lastTimes.fields[field])
+               / static_cast<double>(diffTotal);
+    };
+
+    m_cpuInfo.userPercent = percent(CpuTimes::User);
+    m_cpuInfo.nicePercent = percent(CpuTimes::Nice);
+    m_cpuInfo.systemPercent = percent(CpuTimes::System);
+    m_cpuInfo.idlePercent = percent(CpuTimes::Idle);
+    m_cpuInfo.iowaitPercent = percent(CpuTimes::IoWait);
+    m_cpuInfo.irqPercent = percent(CpuTimes::Irq);
+    m_cpuInfo.softirqPercent = percent(CpuTimes::SoftIrq);
+    m_cpuInfo.stealPercent = percent(CpuTimes::Steal);
+    m_cpuInfo.guestPercent = percent(CpuTimes::Guest);
+    m_cpuInfo.guestNicePercent = percent(CpuTimes::GuestNice);
+}
+
 void CpuMonitorUsage::updateDetailedInfo()
 {
     // Update only working metrics
-    updateLscpuInfo();
-    m_cpuInfo.processes = getProcessCount();
-    m_cpuInfo.threads = getThreadCount();
+    updateTopologyInfo();
+    updateLoadAverage();
     m_cpuInfo.uptime = formatUptime();
 }
 
-void CpuMonitorUsage::updateLscpuInfo()
+void CpuMonitorUsage::setProcessTotals(int processes, int threads)
 {
-    // Run lscpu command
-    QProcess lscpu;
-    lscpu.start("lscpu");
-    lscpu.waitForFinished();
-    QString output = lscpu.readAll();
-
-    static const QRegularExpression whitespaceRegex("\\s+");
-    std::istringstream iss(output.toStdString());
+    m_cpuInfo.processes = processes;
+    m_cpuInfo.threads = threads;
+    m_haveProcessTotals = true;
+}
 
-    int cores = 0;
-    int threadsPerCore = 0;
+void CpuMonitorUsage::updateLoadAverage()
+{
+    // "0.52 0.58 0.59 3/1234 56789" - loads, runnable/total tasks, last pid
+    QFile file("/proc/loadavg");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
 
-    for (std::string line; std::getline(iss, line);) {
-        QString qLine = QString::fromStdString(line);
+    const QList<QByteArray> fields = file.readAll().simplified().split(' ');
+    file.close();
+    if (fields.size() < 4) {
+        return;
+    }
 
-        // Get CPU model name
-        if (qLine.startsWith("model name:", Qt::CaseInsensitive)) {
-            m_cpuInfo.modelName = qLine.mid(qLine.indexOf(':') + 1).trimmed();
-        }
-        // Get sockets
-        else if (qLine.startsWith("socket", Qt::CaseInsensitive)) {
-            QStringList parts = qLine.split(whitespaceRegex, Qt::SkipEmptyParts);
-            if (parts.size() > 1) {
-                m_cpuInfo.sockets = parts[1].toInt();
-            }
-        }
-        // Get cores per socket
-        else if (qLine.startsWith("core(s) per socket", Qt::CaseInsensitive)) {
-            QStringList parts = qLine.split(whitespaceRegex, Qt::SkipEmptyParts);
-            if (parts.size() > 0) {
-                cores = parts.last().toInt();
-                m_cpuInfo.coresPerSocket = cores;
-            }
-        }
-        // Get threads per core to calculate logical processors
-        else if (qLine.startsWith("thread(s) per core", Qt::CaseInsensitive)) {
-            QStringList parts = qLine.split(whitespaceRegex, Qt::SkipEmptyParts);
-            if (parts.size() > 0) {
-                threadsPerCore = parts.last().toInt();
-                if (cores > 0) {
-                    m_cpuInfo.logicalProcessors = cores * threadsPerCore;
-                }
-            }
-        }
+    for (int i = 0; i < 3; ++i) {
+        m_cpuInfo.loadAverage[i] = fields[i].toDouble();
     }
-}
 
-int CpuMonitorUsage::getProcessCount()
-{
-    // Count directories in /proc that are numeric (PIDs)
-    QDir procDir("/proc");
-    QStringList entries = procDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-
-    int count = 0;
-    for (const QString &entry : entries) {
-        bool ok;
-        entry.toInt(&ok);
-        if (ok) {
-            count++;
+    // Until ProcessInfo reports, the kernel's task count stands in for the thread total
+    if (!m_haveProcessTotals) {
+        const int slash = fields[3].indexOf('/');
+        if (slash > 0) {
+            m_cpuInfo.threads = fields[3].mid(slash + 1).toInt();
         }
     }
-
-    return count;
 }
 
-int CpuMonitorUsage::getThreadCount()
+void CpuMonitorUsage::updateTopologyInfo()
 {
-    // Count all threads by checking /proc/[pid]/task directories
-    QDir procDir("/proc");
-    QStringList processes = procDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-
-    int totalThreads = 0;
-    for (const QString &entry : processes) {
-        bool ok;
-        entry.toInt(&ok);
-        if (ok) {
-            QString taskPath = "/proc/" + entry + "/task";
-            QDir taskDir(taskPath);
-            if (taskDir.exists()) {
-                QStringList taskEntries = taskDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-                totalThreads += taskEntries.count();
-            }
-        }
+    // Cheap unless CPUs were hotplugged since the last tick
+    if (!m_topology.refresh()) {
+        return;
     }
 
-    return totalThreads;
+    m_cpuInfo.modelName = m_topology.modelName();
+    m_cpuInfo.sockets = m_topology.sockets();
+    m_cpuInfo.coresPerSocket = m_topology.coresPerSocket();
+    m_cpuInfo.threadsPerCore = m_topology.threadsPerCore();
+    m_cpuInfo.logicalProcessors = m_topology.logicalProcessors();
+    m_cpuInfo.numaNodes = m_topology.numaNodes();
+    m_cpuInfo.cpus = m_topology.cpus();
 }
 
 QString CpuMonitorUsage::formatUptime()
@@ -4,20 +4,42 @@
 
 #include <QObject>
 #include <QString>
-#include <QTimer>
 #include <QVector>
+#include "CpuTopology.h"
+#include "RingBuffer.h"
+#include "SampleScheduler.h"
 
 // Simplified struct with only working metrics
 struct CpuInfo
 {
     double usage;          // Current CPU usage percentage
+    // Share of all CPU time per /proc/stat category over the last tick, in percent.
+    // guest/guestNice are already counted inside user/nice.
+    double userPercent;
+    double nicePercent;
+    double systemPercent;
+    double idlePercent;
+    double iowaitPercent;
+    double irqPercent;
+    double softirqPercent;
+    double stealPercent;
+    double guestPercent;
+    double guestNicePercent;
+    bool hasBreakdown;     // false until two /proc/stat readings gave the shares above
     QString modelName;     // CPU model name
     int sockets;           // Number of CPU sockets
     int coresPerSocket;    // Physical cores per socket
     int logicalProcessors; // Total logical processors (threads)
+    int threadsPerCore;    // SMT siblings per physical core
+    int numaNodes;         // Number of NUMA nodes
     int processes;         // Number of running processes
     int threads;           // Number of running threads
+    int procsRunning;      // Runnable tasks, procs_running in /proc/stat
+    int procsBlocked;      // Tasks blocked on I/O, procs_blocked in /proc/stat
+    double loadAverage[3]; // 1, 5 and 15 minute load from /proc/loadavg
     QString uptime;        // System uptime formatted
+    QVector<CpuTopology::LogicalCpu> cpus; // Topology snapshot, shared until the next hotplug
+    SampleTick tick;       // Scheduler tick the sample was taken on
 };
 
 class CpuMonitorUsage : public QObject
@@ -30,30 +52,54 @@ public:
     double getCurrentUsage() const { return m_currentUsage; }
     QString getUsageString() const;
     CpuInfo getCpuInfo() const { return m_cpuInfo; }
-    QVector<double> getUtilizationHistory() const { return m_utilizationHistory; }
+    const CpuTopology &getTopology() const { return m_topology; }
+    const RingBuffer<double> &getUtilizationHistory() const { return m_utilizationHistory; }
+    int getCoreCount() const { return m_coreUsages.size(); }
+    QVector<double> getCoreUsages() const { return m_coreUsages; }
+
+    // Reads /proc/stat once, called by the sampler thread's scheduler
+    void sample(const SampleTick &tick);
+
+public slots:
+    // Totals from an existing /proc scan (ProcessInfo) so this class never walks /proc itself
+    void setProcessTotals(int processes, int threads);
 
 signals:
     void usageUpdated(double usage);
+    void perCoreUsageUpdated(const QVector<double> &usages);
     void cpuInfoUpdated(const CpuInfo &info);
 
-private slots:
-    void updateCpuUsage();
-
 private:
-    QTimer *m_timer;
+    // Jiffy counters from one cpu/cpuN line of /proc/stat, in column order
+    struct CpuTimes
+    {
+        enum Field { User, Nice, System, Idle, IoWait, Irq, SoftIrq, Steal, Guest, GuestNice, FieldCount };
+        quint64 fields[FieldCount];
+
+        // guest and guest_nice are already included in user and nice
+        quint64 total() const;
+        quint64 idle() const { return fields[Idle] + fields[IoWait]; }
+    };
+
     double m_currentUsage;
-    quint64 m_lastTotal;
-    quint64 m_lastIdle;
+    CpuTimes m_lastTimes;
     bool m_firstRun;
 
     CpuInfo m_cpuInfo;
-    QVector<double> m_utilizationHistory;
+    CpuTopology m_topology;
+    RingBuffer<double> m_utilizationHistory;
+
+    // Per-core state indexed by the N of cpuN, the graphs keep their own history
+    QVector<CpuTimes> m_lastCoreTimes;
+    QVector<double> m_coreUsages;
+    bool m_haveProcessTotals;
 
     // Helper methods - only what works
+    void resizeCores(int count);
     void updateDetailedInfo();
-    void updateLscpuInfo();
-    int getProcessCount();
-    int getThreadCount();
+    void updateBreakdown(const CpuTimes &times);
+    void updateTopologyInfo();
+    void updateLoadAverage();
     QString formatUptime();
 };
 
@@ -0,0 +1,153 @@
+#include "CpuTopology.h"
+#include <QDir>
+#include <QFile>
+#include <QSet>
+
+namespace {
+QByteArray readSysFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll().trimmed();
+}
+
+int readSysInt(const QString &path, int fallback)
+{
+    bool ok;
+    const int value = readSysFile(path).toInt(&ok);
+    return ok ? value : fallback;
+}
+} // namespace
+
+QVector<int> CpuTopology::parseCpuList(const QByteArray &list)
+{
+    // Kernel cpulist format, e.g. "0-3,8-11,16"
+    QVector<int> cpus;
+    for (const QByteArray &range : list.trimmed().split(',')) {
+        if (range.isEmpty()) {
+            continue;
+        }
+
+        const int dash = range.indexOf('-');
+        bool okFirst;
+        bool okLast = true;
+        const int first = range.left(dash < 0 ? range.size() : dash).toInt(&okFirst);
+        const int last = dash < 0 ? first : range.mid(dash + 1).toInt(&okLast);
+        if (!okFirst || !okLast) {
+            continue;
+        }
+
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.append(cpu);
+        }
+    }
+    return cpus;
+}
+
+const CpuTopology::LogicalCpu *CpuTopology::cpu(int id) const
+{
+    if (id < 0 || id >= m_indexById.size() || m_indexById[id] < 0) {
+        return nullptr;
+    }
+    return &m_cpus[m_indexById[id]];
+}
+
+bool CpuTopology::refresh()
+{
+    // One small sysfs read per call, everything else only happens on hotplug
+    QByteArray online = readSysFile("/sys/devices/system/cpu/online");
+    if (online.isEmpty()) {
+        online = QByteArray::number(0);
+    }
+
+    if (!m_cpus.isEmpty() && online == m_onlineList) {
+        return false;
+    }
+
+    m_onlineList = online;
+    if (m_modelName.isEmpty()) {
+        readModelName();
+    }
+    rebuild(parseCpuList(online));
+    return true;
+}
+
+void CpuTopology::rebuild(const QVector<int> &online)
+{
+    m_cpus.clear();
+    m_indexById.clear();
+
+    // NUMA membership comes from the node side, one cpulist per node
+    QVector<int> nodeById;
+    QDir nodeDir("/sys/devices/system/node");
+    const QStringList nodes = nodeDir.entryList({"node*"}, QDir::Dirs);
+    m_numaNodes = 0;
+    for (const QString &node : nodes) {
+        bool ok;
+        const int nodeId = node.mid(4).toInt(&ok);
+        if (!ok) {
+            continue;
+        }
+        m_numaNodes++;
+        for (int cpu : parseCpuList(readSysFile(nodeDir.filePath(node + "/cpulist")))) {
+            if (cpu >= nodeById.size()) {
+                nodeById.resize(cpu + 1, -1);
+            }
+            nodeById[cpu] = nodeId;
+        }
+    }
+
+    QSet<int> sockets;
+    QSet<QPair<int, int>> cores;
+    int maxSiblings = 0;
+
+    for (int id : online) {
+        const QString base = QString("/sys/devices/system/cpu/cpu%1/topology/").arg(id);
+
+        LogicalCpu cpu;
+        cpu.id = id;
+        cpu.socket = readSysInt(base + "physical_package_id", 0);
+        cpu.core = readSysInt(base + "core_id", id);
+        cpu.numaNode = id < nodeById.size() ? nodeById[id] : -1;
+        cpu.siblings = parseCpuList(readSysFile(base + "thread_siblings_list"));
+        if (cpu.siblings.isEmpty()) {
+            cpu.siblings.append(id);
+        }
+
+        sockets.insert(cpu.socket);
+        cores.insert(qMakePair(cpu.socket, cpu.core));
+        maxSiblings = qMax(maxSiblings, static_cast<int>(cpu.siblings.size()));
+
+        if (id >= m_indexById.size()) {
+            m_indexById.resize(id + 1, -1);
+        }
+        m_indexById[id] = m_cpus.size();
+        m_cpus.append(cpu);
+    }
+
+    m_sockets = sockets.size();
+    m_coresPerSocket = m_sockets > 0 ? static_cast<int>(cores.size()) / m_sockets : 0;
+    m_threadsPerCore = maxSiblings;
+}
+
+void CpuTopology::readModelName()
+{
+    QFile file("/proc/cpuinfo");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    // Only the first processor block is needed, stop at its end
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (line.trimmed().isEmpty()) {
+            break;
+        }
+        if (line.startsWith("model name") || line.startsWith("Model")) {
+            m_modelName = QString::fromUtf8(line.mid(line.indexOf(':') + 1)).trimmed();
+            break;
+        }
+    }
+}
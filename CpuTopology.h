@@ -0,0 +1,54 @@
+#ifndef CPUTOPOLOGY_H
+#define CPUTOPOLOGY_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// Socket/core/SMT/NUMA layout of the online CPUs, read from sysfs once and only re-read when
+// /sys/devices/system/cpu/online changes (CPU hotplug)
+class CpuTopology
+{
+public:
+    struct LogicalCpu
+    {
+        int id;             // N of cpuN
+        int socket;         // topology/physical_package_id
+        int core;           // topology/core_id, unique only within a socket
+        int numaNode;       // -1 when the kernel has no NUMA info
+        QVector<int> siblings; // topology/thread_siblings_list, includes this cpu
+    };
+
+    CpuTopology() = default;
+
+    // Returns true when the topology was (re)built
+    bool refresh();
+
+    QString modelName() const { return m_modelName; }
+    int sockets() const { return m_sockets; }
+    int coresPerSocket() const { return m_coresPerSocket; }
+    int threadsPerCore() const { return m_threadsPerCore; }
+    int logicalProcessors() const { return m_cpus.size(); }
+    int numaNodes() const { return m_numaNodes; }
+
+    const QVector<LogicalCpu> &cpus() const { return m_cpus; }
+    // nullptr for offline or unknown cpu ids
+    const LogicalCpu *cpu(int id) const;
+
+    static QVector<int> parseCpuList(const QByteArray &list);
+
+private:
+    void rebuild(const QVector<int> &online);
+    void readModelName();
+
+    QByteArray m_onlineList;
+    QString m_modelName;
+    int m_sockets = 0;
+    int m_coresPerSocket = 0;
+    int m_threadsPerCore = 0;
+    int m_numaNodes = 0;
+    QVector<LogicalCpu> m_cpus;
+    QVector<int> m_indexById;
+};
+
+#endif // CPUTOPOLOGY_H
@@ -1,144 +1,223 @@
 #include "DiskInfo.h"
-#include <QDateTime>
 #include <QDebug>
 #include <QFile>
-#include <QRegularExpression>
-#include <QTextStream>
+#include <QFileInfo>
 #include <sys/sysinfo.h>
-#include<sys/statvfs.h>
 
 DiskInfo::DiskInfo(QObject *parent)
     : QObject(parent)
-    , readIOPS(0)
-    , writeIOPS(0)
-    , readThroughput(0.0)
-    , writtenThroughput(0.0)
-    , prevSectorsRead(0)
-    , prevSectorsWritten(0)
-    , prevTime(0)
-    , totalDiskSpace(0.0)
-    , availDiskSpace(0.0)
-    , usedDiskSpace(0.0)
-    , firstRun(true)
+    , m_generation(0)
+    , prevTimeNs(0)
 
 {
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this, &DiskInfo::updateDiskInfo);
-    m_timer->start(1000);
-    updateDiskInfo();
-    getDiskSpaceInfo();
+    sample(SampleTick::now());
 
 }
 
-void DiskInfo::getDiskSpaceInfo()
+DiskInfo::DeviceState::DeviceState()
+    : generation(0)
 {
-    struct statvfs buf;
-    const char *path = "/";
-    if(statvfs(path, &buf) == 0)
-    {
-        totalDiskSpace = (buf.f_blocks * buf.f_bsize) / (1024.0 * 1024.0 * 1024.0);
-        availDiskSpace = (buf.f_bavail * buf.f_bsize) / (1024.0 * 1024.0 * 1024.0);
-        usedDiskSpace = totalDiskSpace - availDiskSpace;
-    }
-    else
-    {
-        qWarning() << "Failed to get disk space information";
+    // diskstats prints the millisecond fields as unsigned int, they wrap after ~49 days of busy
+    // time, and the request counters as unsigned long
+    for (int field = 0; field < FieldCount; ++field) {
+        const bool ticks = field == ReadTicks || field == WriteTicks || field == IoTicks
+                           || field == QueueTicks || field == DiscardTicks || field == FlushTicks;
+        counters[field] = CounterRate(ticks ? 32 : int(sizeof(unsigned long) * 8));
     }
+}
+
+double DiskInfo::awaitMs(const CounterRate &ticks, const CounterRate &requests)
+{
+    return requests.delta() > 0 ? double(ticks.delta()) / requests.delta() : 0.0;
+}
 
+DiskInfo::DeviceClass DiskInfo::classify(const QString &name)
+{
+    DeviceClass result{false, DeviceStats::Physical, name};
+    const QString path = "/sys/block/" + name;
+    if (!QFileInfo::exists(path)) {
+        return result; // a partition
+    }
+    result.wholeDisk = true;
+
+    if (QFileInfo::exists(path + "/dm")) {
+        result.kind = DeviceStats::DeviceMapper;
+        QFile dmName(path + "/dm/name");
+        if (dmName.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            const QString label = QString::fromUtf8(dmName.readAll()).trimmed();
+            if (!label.isEmpty()) {
+                result.label = label;
+            }
+        }
+    } else if (QFileInfo::exists(path + "/md")) {
+        result.kind = DeviceStats::Md;
+    } else if (QFileInfo::exists(path + "/loop")) {
+        result.kind = DeviceStats::Loop;
+    } else if (!QFileInfo::exists(path + "/device")) {
+        // zram, ram disks and other devices with no hardware behind them
+        result.kind = DeviceStats::Virtual;
+    }
+    return result;
+}
 
+bool DiskInfo::hasBackingFile(const QString &name)
+{
+    // Unattached loop devices report a size of 0
+    QFile size("/sys/block/" + name + "/size");
+    return size.open(QIODevice::ReadOnly | QIODevice::Text) && size.readAll().trimmed() != "0";
 }
 
-void DiskInfo::updateDiskInfo()
+void DiskInfo::sample(const SampleTick &tick)
 {
     QFile file("/proc/diskstats");
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         qDebug() << "Cannot open /proc/diskstats";
         return;
     }
-
-    QString allContent = file.readAll();
+    const QByteArray content = file.readAll();
+    const qint64 readNs = CounterRate::nowNs();
     file.close();
+    const QList<QByteArray> lines = content.split('\n');
 
-    QStringList lines = allContent.split('\n');
-    QRegularExpression whitespaceRegex("\\s+");
-
-    long currentSectorsRead = 0;
-    long currentSectorsWritten = 0;
+    ++m_generation;
 
-    for (int i = 0; i < lines.size() - 1; i++) {
-        QString line = lines[i];
-        QStringList values = line.split(whitespaceRegex, Qt::SkipEmptyParts);
-        if (values.size() >= 14 && !values[2].isEmpty())
-        {
-            //QChar lastChar = values[2].at(values[2].length()-1);
-            //last line was if(values[2] == "vda")
-            //if (!(lastChar.isDigit())) {
-            QString deviceName = values[2];
-
-            static QRegularExpression pattern = QRegularExpression("p\\d+$|[svh]d[a-z]\\d+$");
+    DiskStats stats;
+    //  major minor name reads merged sectors ms writes merged sectors ms ...
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> values = line.simplified().split(' ');
+        if (values.size() < 14) {
+            continue;
+        }
 
-            if(deviceName.contains(pattern))
-            {
+        const QString deviceName = QString::fromLatin1(values[2]);
+        auto cls = m_classes.find(deviceName);
+        if (cls == m_classes.end()) {
+            cls = m_classes.insert(deviceName, classify(deviceName));
+        }
+        cls->generation = m_generation;
+        if (!cls->wholeDisk) {
+            continue;
+        }
+        // Snap hosts carry dozens of loop devices, /sys is only asked when one shows a sign of change
+        if (cls->kind == DeviceStats::Loop) {
+            const quint64 requests = values[3].toULongLong() + values[7].toULongLong();
+            if (cls->checkedNs < 0 || requests != cls->requests
+                || tick.monotonicNs - cls->checkedNs >= LoopRecheckNs) {
+                cls->attached = hasBackingFile(deviceName);
+                cls->requests = requests;
+                cls->checkedNs = tick.monotonicNs;
+            }
+            if (!cls->attached) {
                 continue;
             }
-                readIOPS = values[3].toLong();
-                writeIOPS = values[7].toLong();
-                currentSectorsRead = values[5].toLong();
-                currentSectorsWritten = values[9].toLong();
-                break;
+        }
 
+        DeviceStats device;
+        device.name = deviceName;
+        device.label = cls->label;
+        device.kind = cls->kind;
+        auto state = m_devices.find(deviceName);
+        if (state == m_devices.end()) {
+            state = m_devices.insert(deviceName, DeviceState());
         }
+        state->generation = m_generation;
+        CounterRate *counters = state->counters;
+        for (int field = 0; field < FieldCount; ++field) {
+            if (field != InFlight) {
+                counters[field].update(field + 3 < values.size() ? values[field + 3].toULongLong() : 0,
+                                       readNs);
+            }
+        }
+        device.readsCompleted = counters[Reads].value();
+        device.writesCompleted = counters[Writes].value();
+        device.inFlight = values[InFlight + 3].toULongLong();
+
+        // Same arithmetic as iostat -x, the tick fields are in milliseconds
+        device.readIops = counters[Reads].rate();
+        device.writeIops = counters[Writes].rate();
+        device.readThroughput = counters[SectorsRead].rate() * 512;
+        device.writeThroughput = counters[SectorsWritten].rate() * 512;
+        device.readAwait = awaitMs(counters[ReadTicks], counters[Reads]);
+        device.writeAwait = awaitMs(counters[WriteTicks], counters[Writes]);
+        device.queueSize = counters[QueueTicks].rate() / 1000.0;
+        device.utilization = qMin(100.0, counters[IoTicks].rate() / 10.0);
+        device.discardRate = counters[Discards].rate();
+        device.discardThroughput = counters[SectorsDiscarded].rate() * 512;
+        device.flushRate = counters[Flushes].rate();
+        device.flushAwait = awaitMs(counters[FlushTicks], counters[Flushes]);
+
+        stats.devices.append(device);
     }
 
-    long currentTime = QDateTime::currentMSecsSinceEpoch();
+    // Devices that went away drop their counters
+    for (auto it = m_devices.begin(); it != m_devices.end();) {
+        if (it->generation != m_generation) {
+            it = m_devices.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // Names gone from diskstats, including partitions and detached loops that never had
+    // counters, are classified again if they come back
+    for (auto it = m_classes.begin(); it != m_classes.end();) {
+        if (it->generation != m_generation) {
+            it = m_classes.erase(it);
+        } else {
+            ++it;
+        }
+    }
 
+    const bool firstRun = prevTimeNs == 0;
+    prevTimeNs = tick.monotonicNs;
     if (firstRun) {
-        prevSectorsRead = currentSectorsRead;
-        prevSectorsWritten = currentSectorsWritten;
-        prevTime = currentTime;
-        firstRun = false;
-
-        //emit updateReads(readIOPS);
-        //emit updateWrites(writeIOPS);
         return;
     }
 
-    double elapsedTime = (currentTime - prevTime) / 1000.0;
-
-    if (elapsedTime > 0) {
-        long readSectorsDelta = currentSectorsRead - prevSectorsRead;
-        long writtenSectorsDelta = currentSectorsWritten - prevSectorsWritten;
-
-        readThroughput = (readSectorsDelta * 512) / elapsedTime;
-        writtenThroughput = (writtenSectorsDelta * 512) / elapsedTime;
+    stats.tick = tick;
+    emit diskInfoUpdated(stats);
+}
 
-        prevSectorsRead = currentSectorsRead;
-        prevSectorsWritten = currentSectorsWritten;
-        prevTime = currentTime;
+QString DiskInfo::getLatencyString(const DeviceStats &device)
+{
+    return QString("r_await: %1 ms  w_await: %2 ms  aqu-sz: %3  util: %4%  in flight: %5\n"
+                   "Discards: %6/s (%7 MB/s)  Flushes: %8/s (%9 ms)")
+        .arg(device.readAwait, 0, 'f', 2)
+        .arg(device.writeAwait, 0, 'f', 2)
+        .arg(device.queueSize, 0, 'f', 2)
+        .arg(device.utilization, 0, 'f', 1)
+        .arg(device.inFlight)
+        .arg(device.discardRate, 0, 'f', 1)
+        .arg(device.discardThroughput / (1024.0 * 1024.0), 0, 'f', 2)
+        .arg(device.flushRate, 0, 'f', 1)
+        .arg(device.flushAwait, 0, 'f', 2);
+}
 
-        emit updateReads(readIOPS);
-        emit updateWrites(writeIOPS);
-        emit updateReadThroughput(readThroughput);
-        emit updateWriteThroughput(writtenThroughput);
+QString DiskInfo::kindName(DeviceStats::Kind kind)
+{
+    switch (kind) {
+    case DeviceStats::Physical:
+        return "Disk";
+    case DeviceStats::DeviceMapper:
+        return "Device mapper";
+    case DeviceStats::Md:
+        return "Software RAID";
+    case DeviceStats::Loop:
+        return "Loop";
+    case DeviceStats::Virtual:
+        return "Virtual";
     }
+    return QString();
 }
 
-
-
-QString DiskInfo::getDiskInfoString()
+QString DiskInfo::getDiskInfoString(const DeviceStats &device)
 {
-    double readMBps = readThroughput / (1024.0 * 1024.0);
-    double writeMBps = writtenThroughput / (1024.0 * 1024.0);
-    return QString("Reads Completed: %0 Writes Completed: %1\n"
-                   "Read Throughput: %2 MB/s Write Throughput: %3 MB/s \n"
-                   "Available Disk Space: %4 GB\n"
-                   "Total Disk Space Used: %5 GB / %6GB")
-        .arg(readIOPS)
-        .arg(writeIOPS)
+    double readMBps = device.readThroughput / (1024.0 * 1024.0);
+    double writeMBps = device.writeThroughput / (1024.0 * 1024.0);
+    return QString("Read IOPS: %0 Write IOPS: %1\n"
+                   "Read Throughput: %2 MB/s Write Throughput: %3 MB/s")
+        .arg(device.readIops, 0, 'f', 1)
+        .arg(device.writeIops, 0, 'f', 1)
         .arg(readMBps, 0, 'f', 2)
-        .arg(writeMBps, 0, 'f', 2)
-        .arg(availDiskSpace, 0, 'f', 2)
-        .arg(usedDiskSpace, 0, 'f', 2)
-        .arg(totalDiskSpace,0, 'f', 2 );
+        .arg(writeMBps, 0, 'f', 2);
 
 }
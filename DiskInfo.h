@@ -1,9 +1,48 @@
 #ifndef DISKINFO_H
 #define DISKINFO_H
 
+#include <QHash>
 #include <QObject>
 #include <QString>
-#include <QTimer>
+#include <QVector>
+#include "CounterRate.h"
+#include "SampleScheduler.h"
+
+// One whole-disk block device from /proc/diskstats
+struct DeviceStats
+{
+    // Taken from /sys/block/<name>, which holds whole disks only (partitions are subdirectories)
+    enum Kind { Physical, DeviceMapper, Md, Loop, Virtual };
+
+    QString name;           // kernel name, e.g. nvme0n1 or dm-0
+    QString label;          // dm name (vg-lv) for device mapper, otherwise the kernel name
+    Kind kind;
+    quint64 readsCompleted; // cumulative
+    quint64 writesCompleted;
+    double readIops;        // completed requests/s
+    double writeIops;
+    double readThroughput;  // bytes/s
+    double writeThroughput; // bytes/s
+
+    // iostat -x over the interval: average ms per completed request including queueing,
+    // average requests outstanding and the share of time with at least one in flight
+    double readAwait;
+    double writeAwait;
+    double queueSize;       // aqu-sz
+    double utilization;     // %util, can read 100 on devices that serve requests in parallel
+    quint64 inFlight;       // requests outstanding when diskstats was read
+    double discardRate;     // requests/s
+    double discardThroughput; // bytes/s
+    double flushRate;       // requests/s, 0 on kernels before 5.5
+    double flushAwait;
+};
+
+// Snapshot handed to the widgets after every sample
+struct DiskStats
+{
+    QVector<DeviceStats> devices; // in /proc/diskstats order
+    SampleTick tick;
+};
 
 class DiskInfo : public QObject
 {
@@ -13,39 +52,63 @@ public:
     explicit DiskInfo(QObject *parent = nullptr);
     ~DiskInfo() = default;
 
-    QString getDiskInfoString();
-    void getDiskSpaceInfo();
+    static QString getDiskInfoString(const DeviceStats &device);
+    // await, aqu-sz, %util, discard and flush rates of one device
+    static QString getLatencyString(const DeviceStats &device);
+    static QString kindName(DeviceStats::Kind kind);
 
-signals:
-    void updateReads(long readIOPS);
-    void updateWrites(long writeIOPS);
-    void updateReadThroughput(double readThroughput);
-    void updateWriteThroughput(double writeThroughput);
+    void sample(const SampleTick &tick);
 
-private slots:
-    void updateDiskInfo();
+signals:
+    void diskInfoUpdated(const DiskStats &stats);
 
 private:
-    QTimer *m_timer;
-
-    long readIOPS;
-    long writeIOPS;
-
-    double readThroughput;
-    double writtenThroughput;
-
-    long prevSectorsRead;
-    long prevSectorsWritten;
-
-    long prevTime;
-
-    double totalDiskSpace;
-    double availDiskSpace;
-    double usedDiskSpace;
-
-    bool firstRun;
-
-
+    // What /sys/block said about a diskstats name, looked up once per name
+    struct DeviceClass
+    {
+        bool wholeDisk;
+        DeviceStats::Kind kind;
+        QString label;
+        // Loop devices only: whether a file is attached, checked again when the request
+        // counters move or LoopRecheckNs after the last check
+        bool attached = false;
+        quint64 requests = 0;   // reads + writes at the last check
+        qint64 checkedNs = -1;  // CLOCK_MONOTONIC of the last check, -1 before the first
+        quint64 generation = 0; // last sample the name was in /proc/diskstats
+    };
+
+    static constexpr qint64 LoopRecheckNs = 30000000000LL;
+
+    // Counter columns of /proc/diskstats after the name. Discards came in 4.18 and flushes
+    // in 5.5, they stay 0 on older kernels.
+    enum Field {
+        Reads, ReadsMerged, SectorsRead, ReadTicks,
+        Writes, WritesMerged, SectorsWritten, WriteTicks,
+        InFlight, IoTicks, QueueTicks,
+        Discards, DiscardsMerged, SectorsDiscarded, DiscardTicks,
+        Flushes, FlushTicks,
+        FieldCount
+    };
+
+    // Counters of the previous sample, per device
+    struct DeviceState
+    {
+        DeviceState();
+
+        CounterRate counters[FieldCount]; // InFlight is a gauge and stays unused
+        quint64 generation;
+    };
+
+    static DeviceClass classify(const QString &name);
+    static bool hasBackingFile(const QString &name);
+    // Average ms per request over the last interval, 0 when none completed
+    static double awaitMs(const CounterRate &ticks, const CounterRate &requests);
+
+    QHash<QString, DeviceClass> m_classes;
+    QHash<QString, DeviceState> m_devices;
+    quint64 m_generation;
+
+    qint64 prevTimeNs; // CLOCK_MONOTONIC of the previous tick
 };
 
 #endif // DISKINFO_H
@@ -1,18 +1,34 @@
 #include "MainWindow.h"
 #include <QApplication>
+#include <QComboBox>
+#include <QDateTime>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLabel>
+#include <QLineEdit>
 #include <QListWidget>
 #include <QPalette>
+#include <QScrollArea>
+#include <QSortFilterProxyModel>
 #include <QStackedWidget>
+#include <QTableView>
 #include <QTableWidget>
+#include <QTreeView>
+#include <QTreeWidget>
+#include <QTime>
 #include <QVBoxLayout>
+#include <algorithm>
+#include "CgroupMonitor.h"
 #include "CpuMonitorUsage.h"
 #include "DiskInfo.h"
+#include "MountMonitor.h"
 #include "Network.h"
+#include "PressureStall.h"
 #include "ProcessInfo.h"
+#include "ProcessTableModel.h"
+#include "ProcessTreeModel.h"
 #include "RamUsage.h"
+#include "SamplerThread.h"
 #include "UsageGraph.h"
 #include "PageCustomization.h"
 
@@ -41,8 +57,26 @@ public:
         // Graph at the top
         cpuGraph = new UsageGraph("CPU Usage", 0.0, 100.0, "%", this);
         cpuGraph->setMinimumHeight(300);
+        cpuGraph->setStackedSeries({"User", "System", "I/O wait", "Steal"},
+                                   {QColor(78, 154, 241),
+                                    QColor(229, 72, 77),
+                                    QColor(245, 165, 36),
+                                    QColor(168, 85, 247)});
         layout->addWidget(cpuGraph);
 
+        // One small graph per logical CPU, wrapped in a scroll area so hosts with hundreds of
+        // cores keep a usable layout
+        coreGridHost = new QWidget();
+        coreGrid = new QGridLayout(coreGridHost);
+        coreGrid->setContentsMargins(0, 0, 0, 0);
+        coreGrid->setSpacing(4);
+        coreScroll = new QScrollArea(this);
+        coreScroll->setWidget(coreGridHost);
+        coreScroll->setWidgetResizable(true);
+        coreScroll->setFrameShape(QFrame::NoFrame);
+        coreScroll->setMinimumHeight(160);
+        layout->addWidget(coreScroll);
+
         // Data grid below
         QGridLayout *dataGrid = new QGridLayout();
         dataGrid->setHorizontalSpacing(40);
@@ -53,10 +87,19 @@ public:
         addDataRow(dataGrid, 1, "Processes:", &processesLabel);
         addDataRow(dataGrid, 2, "Threads:", &threadsLabel);
         addDataRow(dataGrid, 3, "Up time:", &uptimeLabel);
+        addDataRow(dataGrid, 4, "Running / blocked:", &runQueueLabel);
+        addDataRow(dataGrid, 5, "Load average:", &loadLabel);
+        addDataRow(dataGrid, 6, "Pressure (some):", &pressureLabel);
+        addDataRow(dataGrid, 7, "Last stall:", &stallLabel);
 
         // Right column
         addDataRow(dataGrid, 0, "Sockets:", &socketsLabel, 2);
         addDataRow(dataGrid, 1, "Cores:", &coresLabel, 2);
+        addDataRow(dataGrid, 2, "Logical processors:", &logicalLabel, 2);
+        addDataRow(dataGrid, 3, "NUMA nodes:", &numaLabel, 2);
+        addDataRow(dataGrid, 4, "User / System:", &userSystemLabel, 2);
+        addDataRow(dataGrid, 5, "I/O wait / Steal:", &iowaitStealLabel, 2);
+        addDataRow(dataGrid, 6, "Pressure (full):", &fullPressureLabel, 2);
 
         layout->addLayout(dataGrid);
         layout->addStretch();
@@ -97,19 +140,38 @@ public:
             }
         });
 
-        // Connect to monitor
-        cpuMonitor = new CpuMonitorUsage(this);
+        // Connect to monitor, it lives on the sampler thread once adopted below
+        cpuMonitor = new CpuMonitorUsage();
         connect(cpuMonitor, &CpuMonitorUsage::usageUpdated, this, &CpuWidget::updateUsage);
         connect(cpuMonitor, &CpuMonitorUsage::cpuInfoUpdated, this, &CpuWidget::updateCpuInfo);
+        connect(cpuMonitor,
+                &CpuMonitorUsage::perCoreUsageUpdated,
+                this,
+                &CpuWidget::updateCoreUsages);
 
-        const QVector<double> history = cpuMonitor->getUtilizationHistory();
-        for (double value : history) {
-            cpuGraph->addUtilizationValue(value);
-        }
+        topology = cpuMonitor->getCpuInfo().cpus;
+        rebuildCoreGrid(cpuMonitor->getCoreCount());
+
+        // PSI: the trigger reports a stall as soon as the kernel sees it, not on the next tick
+        cpuPressure = new PressureStall(PressureStall::Cpu);
+        connect(cpuPressure, &PressureStall::pressureUpdated, this, &CpuWidget::updatePressure);
+        connect(cpuPressure, &PressureStall::stallTriggered, this, [this](bool) {
+            stallLabel->setText(QTime::currentTime().toString("hh:mm:ss"));
+        });
+        cpuPressure->addTrigger(false, 100000, 2000000);
+        stallLabel->setText("None");
+        updatePressure(cpuPressure->getPressureInfo());
+
+        // Direct calls into the collectors are only safe up to here
+        SamplerThread::instance()->adopt(cpuMonitor);
+        SamplerThread::instance()->adopt(cpuPressure);
 
         setStyleSheet("QWidget { background-color: #1e1e1e; }");
     }
 
+    // For wiring to other collectors only, the monitor lives on the sampler thread
+    CpuMonitorUsage *monitor() const { return cpuMonitor; }
+
 private:
     void addDataRow(
         QGridLayout *grid, int row, const QString &label, QLabel **valueLabel, int colOffset = 0)
@@ -125,11 +187,81 @@ private:
         grid->addWidget(val, row, 1 + colOffset);
     }
 
+    QString coreToolTip(int core) const
+    {
+        for (const CpuTopology::LogicalCpu &cpu : topology) {
+            if (cpu.id == core) {
+                return QString("CPU %1\nSocket %2, Core %3, NUMA node %4\nSMT siblings: %5")
+                    .arg(core)
+                    .arg(cpu.socket)
+                    .arg(cpu.core)
+                    .arg(cpu.numaNode)
+                    .arg(cpu.siblings.size());
+            }
+        }
+        return QString("CPU %1").arg(core);
+    }
+
+    void rebuildCoreGrid(int coreCount)
+    {
+        qDeleteAll(coreGraphs);
+        coreGraphs.clear();
+
+        // Roughly square grid, 4 columns minimum and 16 maximum
+        int columns = 4;
+        while (columns < 16 && columns * columns < coreCount) {
+            columns++;
+        }
+
+        for (int core = 0; core < coreCount; ++core) {
+            UsageGraph *graph = new UsageGraph(false, coreGridHost);
+            graph->setFixedHeight(48);
+            graph->setTextColor(cpuGraph->getTextColor());
+            graph->setToolTip(coreToolTip(core));
+            coreGrid->addWidget(graph, core / columns, core % columns);
+            coreGraphs.append(graph);
+        }
+    }
+
 private slots:
     void updateUsage(double usage)
     {
         utilLabel->setText(QString::number(usage, 'f', 1) + "%");
-        cpuGraph->addUtilizationValue(usage);
+        // The stacked bands come from updateCpuInfo, a line value would never be drawn
+        if (!cpuGraph->isStacked()) {
+            cpuGraph->addUtilizationValue(usage);
+        }
+    }
+
+    void updatePressure(const PressureInfo &info)
+    {
+        if (!info.available) {
+            pressureLabel->setText("N/A");
+            fullPressureLabel->setText("N/A");
+            return;
+        }
+        pressureLabel->setText(QString("%1%  %2%  %3%")
+                                   .arg(info.some[0], 0, 'f', 2)
+                                   .arg(info.some[1], 0, 'f', 2)
+                                   .arg(info.some[2], 0, 'f', 2));
+        fullPressureLabel->setText(info.hasFull ? QString("%1%  %2%  %3%")
+                                                      .arg(info.full[0], 0, 'f', 2)
+                                                      .arg(info.full[1], 0, 'f', 2)
+                                                      .arg(info.full[2], 0, 'f', 2)
+                                                : QString("N/A"));
+    }
+
+    void updateCoreUsages(const QVector<double> &usages)
+    {
+        // CPU hotplug changes the number of cpuN lines
+        if (usages.size() != coreGraphs.size()) {
+            rebuildCoreGrid(usages.size());
+            return;
+        }
+
+        for (int core = 0; core < usages.size(); ++core) {
+            coreGraphs[core]->addUtilizationValue(usages[core]);
+        }
     }
 
     void updateCpuInfo(const CpuInfo &info)
@@ -138,21 +270,140 @@ private slots:
         processesLabel->setText(QString::number(info.processes));
         threadsLabel->setText(QString::number(info.threads));
         uptimeLabel->setText(info.uptime);
+        runQueueLabel->setText(QString("%1 / %2").arg(info.procsRunning).arg(info.procsBlocked));
+        loadLabel->setText(QString("%1  %2  %3")
+                               .arg(info.loadAverage[0], 0, 'f', 2)
+                               .arg(info.loadAverage[1], 0, 'f', 2)
+                               .arg(info.loadAverage[2], 0, 'f', 2));
         socketsLabel->setText(QString::number(info.sockets));
-        coresLabel->setText(QString::number(info.coresPerSocket));
+        coresLabel->setText(QString("%1 x %2 threads")
+                                .arg(info.coresPerSocket)
+                                .arg(info.threadsPerCore));
+        logicalLabel->setText(QString::number(info.logicalProcessors));
+
+        // The snapshot shares the collector's topology until a hotplug rebuilds it
+        if (info.cpus.constData() != topology.constData()) {
+            topology = info.cpus;
+            for (int core = 0; core < coreGraphs.size(); ++core) {
+                coreGraphs[core]->setToolTip(coreToolTip(core));
+            }
+        }
+        numaLabel->setText(QString::number(info.numaNodes));
+
+        // irq/softirq are kernel time, so they go in the system band
+        const double user = info.userPercent + info.nicePercent;
+        const double system = info.systemPercent + info.irqPercent + info.softirqPercent;
+        userSystemLabel->setText(
+            QString("%1% / %2%").arg(user, 0, 'f', 1).arg(system, 0, 'f', 1));
+        iowaitStealLabel->setText(QString("%1% / %2%")
+                                      .arg(info.iowaitPercent, 0, 'f', 1)
+                                      .arg(info.stealPercent, 0, 'f', 1));
+        // The first reading has no interval yet, all zeros would draw a false dip
+        if (info.hasBreakdown) {
+            cpuGraph->addStackedValues({user, system, info.iowaitPercent, info.stealPercent});
+        }
     }
 
 private:
     QLabel *cpuModelLabel;
     QLabel *utilLabel, *processesLabel, *threadsLabel, *uptimeLabel;
-    QLabel *socketsLabel, *coresLabel;
+    QLabel *runQueueLabel, *loadLabel;
+    QLabel *userSystemLabel, *iowaitStealLabel;
+    QLabel *socketsLabel, *coresLabel, *logicalLabel, *numaLabel;
+    QLabel *pressureLabel, *fullPressureLabel, *stallLabel;
     CpuMonitorUsage *cpuMonitor;
+    PressureStall *cpuPressure;
     UsageGraph *cpuGraph;
+    QScrollArea *coreScroll;
+    QWidget *coreGridHost;
+    QGridLayout *coreGrid;
+    QVector<UsageGraph *> coreGraphs;
+    QVector<CpuTopology::LogicalCpu> topology;
     QPushButton *backgroundColor_btn;
     QPushButton *textColor_btn;
     QPushButton *applyAllPages_btn;
 };
 
+// Selector and stacked graph pages, one page per device or interface. Every page keeps recording
+// while another is shown, and a page that was not touched by the latest sample is dropped.
+// Graphs holds the page's graphs and its page widget, the page stays nullptr until addPage.
+template<typename Graphs>
+class GraphPageStack : public QWidget
+{
+public:
+    GraphPageStack(int pageHeight, QWidget *parent = nullptr)
+        : QWidget(parent)
+    {
+        QVBoxLayout *layout = new QVBoxLayout(this);
+        layout->setContentsMargins(0, 0, 0, 0);
+
+        selector = new QComboBox(this);
+        selector->setMaximumWidth(400);
+        selector->setStyleSheet(
+            "QComboBox { background-color: #2d2d2d; color: white; border: 1px solid #3d3d3d; padding: 4px; }");
+        layout->addWidget(selector, 0, Qt::AlignCenter);
+
+        stack = new QStackedWidget(this);
+        stack->setMinimumHeight(pageHeight);
+        layout->addWidget(stack);
+
+        connect(selector, &QComboBox::currentIndexChanged, this, [this](int index) {
+            const auto entry = entries.constFind(selector->itemData(index).toString());
+            if (entry != entries.cend()) {
+                stack->setCurrentWidget(entry->graphs.page);
+            }
+        });
+    }
+
+    // Emits currentIndexChanged after the shown page was switched
+    QComboBox *comboBox() const { return selector; }
+    QString currentKey() const { return selector->currentData().toString(); }
+    void setCurrentKey(const QString &key) { selector->setCurrentIndex(selector->findData(key)); }
+
+    // Graphs of key, marked as listed in the sample with this tick sequence
+    Graphs &touch(const QString &key, quint64 sequence)
+    {
+        Entry &entry = entries[key];
+        entry.generation = sequence;
+        return entry.graphs;
+    }
+
+    // Creates the empty page of key's Graphs and lists it in the selector under label. The page is
+    // stored first, the selector makes the first item current as soon as it is added.
+    void addPage(const QString &key, const QString &label)
+    {
+        QWidget *&page = entries[key].graphs.page;
+        page = new QWidget(stack);
+        stack->addWidget(page);
+        selector->addItem(label, key);
+    }
+
+    // Pages not touched in the sample with this tick sequence, a key that comes back starts over
+    void removeStale(quint64 sequence)
+    {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->generation != sequence) {
+                selector->removeItem(selector->findData(it.key()));
+                delete it->graphs.page;
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+private:
+    struct Entry
+    {
+        Graphs graphs;
+        quint64 generation = 0;
+    };
+
+    QComboBox *selector;
+    QStackedWidget *stack;
+    QHash<QString, Entry> entries;
+};
+
 // Network widget
 class NetWidget : public QWidget
 {
@@ -170,23 +421,9 @@ public:
             "QLabel { color: white; font-size: 18px; font-weight: 500; margin-bottom: 20px; }");
         layout->addWidget(title);
 
-        // container for graphs
-        QHBoxLayout *graphLayout = new QHBoxLayout();
-        graphLayout->setSpacing(20); // Add some spacing between graphs
-
-        // bytes received graph
-        recvGraph = new UsageGraph("Received", 0, 1000, " Kbps", this);
-        recvGraph->setMinimumHeight(350);
-        recvGraph->setMaximumWidth(400); // prevent horizontal stretching
-        graphLayout->addWidget(recvGraph);
-
-        // bytes sent graph
-        sentGraph = new UsageGraph("Sent", 0, 1000, " Kbps", this);
-        sentGraph->setMinimumHeight(350);
-        sentGraph->setMaximumWidth(400);
-        graphLayout->addWidget(sentGraph);
-        // adds graphs to main layout
-        layout->addLayout(graphLayout);
+        // Every interface and the aggregate get their own graph pair
+        interfacePages = new GraphPageStack<InterfaceGraphs>(350, this);
+        layout->addWidget(interfacePages);
 
         // interface's name display
         interfaceLabel = new QLabel("Adapter: N/A");
@@ -224,6 +461,12 @@ public:
         bytesSentLabel->setStyleSheet("QLabel { color: white; font-size: 18px; }");
         layout->addWidget(bytesSentLabel);
 
+        // Packet, error and drop rates
+        packetsLabel = new QLabel("Packets: 0/s in, 0/s out");
+        packetsLabel->setAlignment(Qt::AlignCenter);
+        packetsLabel->setStyleSheet("QLabel { color: white; font-size: 14px; }");
+        layout->addWidget(packetsLabel);
+
         // Change background color button
         backgroundColor_btn = new QPushButton("Change Background Color");
         backgroundColor_btn->setStyleSheet("QPushButton { color: white; font-size: 15px; max-width: 250px; border: 1px solid white; border-radius: 2px}");
@@ -261,9 +504,11 @@ public:
         });
 
         // Create and connect network monitor
-        interfaceMonitor = new networkStats(this);
+        interfaceMonitor = new networkStats();
         connect(interfaceMonitor, &networkStats::updateIfaceData, this, &NetWidget::updateNetSpecs);
-        connect(interfaceMonitor, &networkStats::updatedThroughput, this, &NetWidget::updateNetData);
+        connect(interfaceMonitor, &networkStats::statsUpdated, this, &NetWidget::updateNetData);
+        connect(interfacePages->comboBox(), &QComboBox::currentIndexChanged, this, &NetWidget::showInterface);
+        SamplerThread::instance()->adopt(interfaceMonitor);
         layout->addStretch(); // Push content to top
         setStyleSheet("QWidget { background-color: #1e1e1e; }");
     }
@@ -277,70 +522,138 @@ private slots:
         ipv4Label->setText(QString("IPv4 Address:  %1").arg(ipv4));
     }
 
-    void updateNetData(quint64 recBits, QString recSpeed, quint64 senBits, QString senSpeed)
+    void updateNetData(const NetStats &stats)
     {
+        lastStats = stats;
+        plotInterface(QString(), stats.aggregate, stats.tick.sequence);
+        for (const InterfaceStats &iface : stats.interfaces) {
+            plotInterface(iface.name, iface, stats.tick.sequence);
+        }
+
+        // The aggregate is plotted on every sample, so only real interfaces can go away
+        interfacePages->removeStale(stats.tick.sequence);
+
+        // Start on the first interface that is not loopback, like the monitor does
+        if (!interfaceChosen) {
+            for (const InterfaceStats &iface : stats.interfaces) {
+                if (!iface.loopback) {
+                    interfacePages->setCurrentKey(iface.name);
+                    break;
+                }
+            }
+            interfaceChosen = true;
+        }
+        updateLabels();
+    }
+
+    void showInterface()
+    {
+        const QString name = interfacePages->currentKey();
+        updateLabels();
+
+        // The monitor lives on the sampler thread, hand the change over to it
+        networkStats *monitor = interfaceMonitor;
+        QMetaObject::invokeMethod(monitor, [monitor, name]() {
+            monitor->setInterface(name);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    struct InterfaceGraphs
+    {
+        QWidget *page = nullptr;
+        UsageGraph *recvGraph = nullptr;
+        UsageGraph *sentGraph = nullptr;
+        QString recvUnit;
+        QString sentUnit;
+    };
+
+    // Graph values are in Kbps, the range follows the unit the current rate is shown in
+    static void plotRate(UsageGraph *graph, double bytesPerSecond, QString &currentUnit)
+    {
+        QString unit;
+        networkStats::scaleBits(bytesPerSecond, unit);
+        // Only rescale on a unit change so the graph is not redrawn from scratch every second
+        if (unit != currentUnit) {
+            graph->setRange(0, unit == "Kb" ? 1000 : unit == "Mb" ? 1000000 : 1000000 * 1000.0);
+            graph->setUnit(QString(" %1ps").arg(unit));
+            currentUnit = unit;
+        }
+        graph->addUtilizationValue((bytesPerSecond * 8) / 1000);
+    }
+
+    void plotInterface(const QString &name, const InterfaceStats &iface, quint64 sequence)
+    {
+        InterfaceGraphs &graphs = interfacePages->touch(name, sequence);
+        if (!graphs.page) {
+            interfacePages->addPage(name, name.isEmpty() ? iface.name
+                                                         : (iface.loopback ? name + " (loopback)" : name));
+            QHBoxLayout *graphLayout = new QHBoxLayout(graphs.page);
+            graphLayout->setContentsMargins(0, 0, 0, 0);
+            graphLayout->setSpacing(20); // Add some spacing between graphs
+
+            // bytes received graph
+            graphs.recvGraph = new UsageGraph("Received", 0, 1000, " Kbps", graphs.page);
+            graphs.recvGraph->setMinimumHeight(350);
+            graphs.recvGraph->setMaximumWidth(400); // prevent horizontal stretching
+            graphLayout->addWidget(graphs.recvGraph);
+
+            // bytes sent graph
+            graphs.sentGraph = new UsageGraph("Sent", 0, 1000, " Kbps", graphs.page);
+            graphs.sentGraph->setMinimumHeight(350);
+            graphs.sentGraph->setMaximumWidth(400);
+            graphLayout->addWidget(graphs.sentGraph);
+
+            graphs.recvUnit = "Kb";
+            graphs.sentUnit = "Kb";
+        }
+        plotRate(graphs.recvGraph, iface.rxBytesRate, graphs.recvUnit);
+        plotRate(graphs.sentGraph, iface.txBytesRate, graphs.sentUnit);
+    }
+
+    void updateLabels()
+    {
+        const QString name = interfacePages->currentKey();
+        const InterfaceStats *iface = name.isEmpty() ? &lastStats.aggregate : nullptr;
+        for (const InterfaceStats &candidate : lastStats.interfaces) {
+            if (!iface && candidate.name == name) {
+                iface = &candidate;
+            }
+        }
+        if (!iface) {
+            return;
+        }
+
+        QString recUnit;
+        QString senUnit;
+        const double recSpeed = networkStats::scaleBits(iface->rxBytesRate, recUnit);
+        const double senSpeed = networkStats::scaleBits(iface->txBytesRate, senUnit);
         bytesReceivedLabel->setText(
-            QString("Received:  %1 %2ps").arg(QString::number(recBits, 'f', 2), recSpeed));
+            QString("Received:  %1 %2ps").arg(QString::number(recSpeed, 'f', 2), recUnit));
         bytesSentLabel->setText(
-            QString("Sent:  %1 %2ps").arg(QString::number(senBits, 'f', 2), senSpeed));
-
-        if (recSpeed == "Kb") {
-            // These repetitive if statements stop the graphs from being continuously redrawn every time the update function is called (1 second interval)
-            if (currentSpeed_Rec != recSpeed) {
-                recvGraph->setRange(0, 1000);
-            };
-        } else if (recSpeed == "Mb") {
-            recBits = recBits * 1000;
-            if (currentSpeed_Rec != recSpeed) {
-                recvGraph->setRange(0, 1000000);
-            };
-        } else if (recSpeed == "Gb") {
-            recBits = recBits * 1000000;
-            if (currentSpeed_Rec != recSpeed) {
-                recvGraph->setRange(0, 1000000 * 1000);
-            };
-        };
-
-
-        if (senSpeed == "Kb") {
-            if (currentSpeed_Sen != senSpeed) {
-                sentGraph->setRange(0, 1000);
-            };
-        } else if (senSpeed == "Mb") {
-            senBits = senBits * 1000;
-            if (currentSpeed_Sen != senSpeed) {
-                sentGraph->setRange(0, 1000000);
-            };
-        } else if (senSpeed == "Gb") {
-            senBits = senBits * 1000000;
-            if (currentSpeed_Sen != senSpeed) {
-                sentGraph->setRange(0, 1000000 * 1000);
-            };
-        };
-
-        currentSpeed_Rec = recSpeed;
-        currentSpeed_Sen = senSpeed;
-
-        recvGraph->setUnit(QString(" %1ps").arg(recSpeed));
-        recvGraph->addUtilizationValue(recBits); // gives received graph its data
-
-        sentGraph->setUnit(QString(" %1ps").arg(senSpeed));
-        sentGraph->addUtilizationValue(senBits); // gives sent graph its data
+            QString("Sent:  %1 %2ps").arg(QString::number(senSpeed, 'f', 2), senUnit));
+        packetsLabel->setText(QString("Packets: %1/s in, %2/s out\n"
+                                      "Errors: %3/s in, %4/s out  Drops: %5/s in, %6/s out")
+                                  .arg(iface->rxPacketsRate, 0, 'f', 0)
+                                  .arg(iface->txPacketsRate, 0, 'f', 0)
+                                  .arg(iface->rxErrorsRate, 0, 'f', 1)
+                                  .arg(iface->txErrorsRate, 0, 'f', 1)
+                                  .arg(iface->rxDropsRate, 0, 'f', 1)
+                                  .arg(iface->txDropsRate, 0, 'f', 1));
     }
 
-private:
     QLabel *interfaceLabel;
     QLabel *connectionLabel;
     QLabel *ipv6Label;
     QLabel *ipv4Label;
     QLabel *bytesReceivedLabel;
     QLabel *bytesSentLabel;
-    networkStats *interfaceSpecs;
+    QLabel *packetsLabel;
     networkStats *interfaceMonitor;
-    QString currentSpeed_Sen;
-    QString currentSpeed_Rec;
-    UsageGraph *recvGraph;
-    UsageGraph *sentGraph;
+    // Keyed by interface name, the aggregate under the empty name
+    GraphPageStack<InterfaceGraphs> *interfacePages;
+    NetStats lastStats;
+    bool interfaceChosen = false;
     QPushButton *backgroundColor_btn;
     QPushButton *textColor_btn;
     QPushButton *applyAllPages_btn;
@@ -362,7 +675,7 @@ public:
             "QLabel{ color: white; font-size: 18px; font-weight: 500; margin-bottom: 20px;}");
         layout->addWidget(title);
 
-        ramMonitor = new RamUsage(this);
+        ramMonitor = new RamUsage();
         // Create Usage Graph
         double const range = (ramMonitor->getTotalSysRam()) / (1024.0 * 1024.0);
         ramGraph = new UsageGraph("Ram Usage", 0.0, range, "GB", this);
@@ -375,6 +688,11 @@ public:
         ramUsageLabel->setStyleSheet("QLabel { color: white; font-size: 18px; }");
         layout->addWidget(ramUsageLabel);
 
+        memPressureLabel = new QLabel("Pressure: N/A");
+        memPressureLabel->setAlignment(Qt::AlignCenter);
+        memPressureLabel->setStyleSheet("QLabel { color: white; font-size: 14px; }");
+        layout->addWidget(memPressureLabel);
+
         // Change background color button
         backgroundColor_btn = new QPushButton("Change Background Color");
         backgroundColor_btn->setStyleSheet("QPushButton { color: white; font-size: 15px; max-width: 250px; border: 1px solid white; border-radius: 2px}");
@@ -414,19 +732,45 @@ public:
         // Connects monitor to update ram usage functions
         connect(ramMonitor, &RamUsage::ramUsageUpdated, this, &RamWidget::updateUsage);
 
+        memPressure = new PressureStall(PressureStall::Memory);
+        connect(memPressure, &PressureStall::pressureUpdated, this, &RamWidget::updatePressure);
+        connect(memPressure, &PressureStall::stallTriggered, this, [this](bool) {
+            lastStall = QTime::currentTime().toString("hh:mm:ss");
+            updatePressure(lastPressure);
+        });
+        memPressure->addTrigger(false, 100000, 2000000);
+        updatePressure(memPressure->getPressureInfo());
+
+        SamplerThread::instance()->adopt(ramMonitor);
+        SamplerThread::instance()->adopt(memPressure);
+
         layout->addStretch();
         setStyleSheet("QWidget { background-color: #1e1e1e;}");
     }
 private slots:
-    void updateUsage(long usedRamKB)
+    void updateUsage(const RamInfo &info)
     {
-        double usedRamGB = usedRamKB / (1024.0 * 1024.0);
-        ramUsageLabel->setText(ramMonitor->getRamUsageString());
+        double usedRamGB = info.usedKB / (1024.0 * 1024.0);
+        ramUsageLabel->setText(RamUsage::getRamUsageString(info));
         ramGraph->addUtilizationValue(usedRamGB);
     }
 
+    void updatePressure(const PressureInfo &info)
+    {
+        lastPressure = info;
+        QString text = PressureStall::getPressureString(info);
+        if (!lastStall.isEmpty()) {
+            text += QString("\nLast stall: %1").arg(lastStall);
+        }
+        memPressureLabel->setText(text);
+    }
+
 private:
     QLabel *ramUsageLabel;
+    QLabel *memPressureLabel;
+    PressureInfo lastPressure;
+    QString lastStall;
+    PressureStall *memPressure;
     RamUsage *ramMonitor;
     UsageGraph *ramGraph;
     QPushButton *backgroundColor_btn;
@@ -449,24 +793,11 @@ public:
             "QLabel{ color: white; font-size: 18px; font-weight: 500; margin-bottom: 20px;}");
         layout->addWidget(title);
 
-        diskMonitor = new DiskInfo(this);
-
-        // container for graphs
-        QHBoxLayout *graphLayout = new QHBoxLayout();
-        graphLayout->setSpacing(20); // Add some spacing between graphs
-
-        readGraph = new UsageGraph("Read Throughput", 0.0, 3000.00, "MB/s", this);
-        readGraph->setMinimumHeight(350);
-        layout->addWidget(readGraph);
-        readGraph->setMaximumWidth(400); // Prevent horizontal stretching
-        graphLayout->addWidget(readGraph);
-        layout->addLayout(graphLayout);
+        diskMonitor = new DiskInfo();
 
-        writeGraph = new UsageGraph("Write Throughput", 0.0, 3000.00, "MB/s", this);
-        writeGraph->setMinimumHeight(350);
-        layout->addWidget(writeGraph);
-        writeGraph->setMaximumWidth(400); // Prevent horizontal stretching
-        graphLayout->addWidget(writeGraph);
+        // Every whole disk gets its own throughput and IOPS graphs
+        devicePages = new GraphPageStack<DeviceGraphs>(520, this);
+        layout->addWidget(devicePages);
 
         diskUsageLabel = new QLabel("Reads Completed: 0 Writes Completed: 0\n"
                                     "Read Throughput: 1 MB/s Write Throughput: 2 MB/s");
@@ -475,6 +806,31 @@ public:
         diskUsageLabel->setStyleSheet("QLabel { color: white; font-size: 18px; }");
         layout->addWidget(diskUsageLabel);
 
+        // Latency, queue depth and saturation of the selected device
+        diskLatencyLabel = new QLabel("r_await: 0.00 ms  w_await: 0.00 ms  aqu-sz: 0.00  util: 0.0%");
+        diskLatencyLabel->setAlignment(Qt::AlignCenter);
+        diskLatencyLabel->setStyleSheet("QLabel { color: white; font-size: 14px; }");
+        layout->addWidget(diskLatencyLabel);
+
+        // Capacity of every real mount, refreshed on a slow cadence and when the mount table changes
+        mountTable = new QTableWidget(this);
+        mountTable->setColumnCount(MountColumnCount);
+        mountTable->setHorizontalHeaderLabels({"Mount", "Device", "Type", "Used", "Free", "Size", "Use %", "Inodes Used", "Inodes Free"});
+        mountTable->verticalHeader()->hide();
+        mountTable->horizontalHeader()->setStretchLastSection(true);
+        mountTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        mountTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        mountTable->setStyleSheet(
+            "QAbstractItemView { background-color: #2d2d2d; color: white; }"
+            "QHeaderView::section { background-color: #3d3d3d; color: white; padding: 5px; }");
+        mountTable->setMaximumHeight(200);
+        layout->addWidget(mountTable);
+
+        ioPressureLabel = new QLabel("Pressure: N/A");
+        ioPressureLabel->setAlignment(Qt::AlignCenter);
+        ioPressureLabel->setStyleSheet("QLabel { color: white; font-size: 14px; }");
+        layout->addWidget(ioPressureLabel);
+
         // Change background color button
         backgroundColor_btn = new QPushButton("Change Background Color");
         backgroundColor_btn->setStyleSheet("QPushButton { color: white; font-size: 15px; max-width: 250px; border: 1px solid white; border-radius: 2px}");
@@ -511,41 +867,176 @@ public:
             }
         });
 
-        connect(diskMonitor, &DiskInfo::updateReads, this, &DiskWidget::updateDiskInfo);
-        connect(diskMonitor, &DiskInfo::updateWrites, this, &DiskWidget::updateDiskInfo);
-        connect(diskMonitor,
-                &DiskInfo::updateReadThroughput,
-                this,
-                &DiskWidget::updateReadThroughputGraph);
-        connect(diskMonitor,
-                &DiskInfo::updateWriteThroughput,
-                this,
-                &DiskWidget::updateWriteThroughputGraph);
+        connect(diskMonitor, &DiskInfo::diskInfoUpdated, this, &DiskWidget::updateDiskInfo);
+        connect(devicePages->comboBox(), &QComboBox::currentIndexChanged, this, &DiskWidget::showDevice);
+
+        ioPressure = new PressureStall(PressureStall::Io);
+        connect(ioPressure, &PressureStall::pressureUpdated, this, &DiskWidget::updatePressure);
+        connect(ioPressure, &PressureStall::stallTriggered, this, [this](bool) {
+            lastStall = QTime::currentTime().toString("hh:mm:ss");
+            updatePressure(lastPressure);
+        });
+        ioPressure->addTrigger(false, 100000, 2000000);
+        updatePressure(ioPressure->getPressureInfo());
+
+        mountMonitor = new MountMonitor();
+        connect(mountMonitor, &MountMonitor::mountsUpdated, this, &DiskWidget::updateMounts);
+
+        SamplerThread::instance()->adopt(diskMonitor);
+        SamplerThread::instance()->adopt(mountMonitor, MountCadenceTicks);
+        SamplerThread::instance()->adopt(ioPressure);
 
         layout->addStretch();
         setStyleSheet("QWidget { background-color: #1e1e1e;}");
     }
 private slots:
-    void updateDiskInfo() { diskUsageLabel->setText(diskMonitor->getDiskInfoString()); }
+    void updateDiskInfo(const DiskStats &stats)
+    {
+        lastStats = stats;
+        for (const DeviceStats &device : stats.devices) {
+            DeviceGraphs &graphs = devicePages->touch(device.name, stats.tick.sequence);
+            if (!graphs.page) {
+                addDevice(device, graphs);
+            }
+            graphs.readGraph->addUtilizationValue(device.readThroughput / (1024.0 * 1024.0));
+            graphs.writeGraph->addUtilizationValue(device.writeThroughput / (1024.0 * 1024.0));
+            graphs.readIopsGraph->addUtilizationValue(device.readIops);
+            graphs.writeIopsGraph->addUtilizationValue(device.writeIops);
+        }
+
+        devicePages->removeStale(stats.tick.sequence);
+        showDevice();
+    }
 
-    void updateReadThroughputGraph(double readBytesPerSec)
+    void showDevice()
     {
-        double readMBps = readBytesPerSec / (1024.0 * 1024.0);
-        qDebug() << "Read throughput:" << readMBps << "MB/s";
-        readGraph->addUtilizationValue(readMBps);
+        const QString name = devicePages->currentKey();
+        for (const DeviceStats &device : lastStats.devices) {
+            if (device.name == name) {
+                diskUsageLabel->setText(DiskInfo::getDiskInfoString(device));
+                diskLatencyLabel->setText(DiskInfo::getLatencyString(device));
+                break;
+            }
+        }
     }
 
-    void updateWriteThroughputGraph(double writtenBytesPerSec)
+    void updateMounts(const QVector<MountUsage> &mounts)
     {
-        double writeMBps = writtenBytesPerSec / (1024.0 * 1024.0);
-        writeGraph->addUtilizationValue(writeMBps);
+        // Items are reused across updates, only the texts change
+        const int previousRows = mountTable->rowCount();
+        mountTable->setRowCount(mounts.size());
+        for (int i = 0; i < mounts.size(); ++i) {
+            const MountUsage &mount = mounts[i];
+            if (i >= previousRows) {
+                for (int column = 0; column < MountColumnCount; ++column) {
+                    mountTable->setItem(i, column, new QTableWidgetItem());
+                }
+            }
+            const quint64 usable = mount.usedBytes + mount.freeBytes;
+            mountTable->item(i, MountPointColumn)->setText(mount.readOnly ? mount.mountPoint + " (ro)" : mount.mountPoint);
+            mountTable->item(i, MountDeviceColumn)->setText(mount.source);
+            mountTable->item(i, MountTypeColumn)->setText(mount.fsType);
+            mountTable->item(i, MountUsedColumn)->setText(formatBytes(mount.usedBytes));
+            mountTable->item(i, MountFreeColumn)->setText(formatBytes(mount.freeBytes));
+            mountTable->item(i, MountSizeColumn)->setText(formatBytes(mount.totalBytes));
+            // Like df, the share of what non-root users can use
+            mountTable->item(i, MountPercentColumn)->setText(
+                usable > 0 ? QString::number(100.0 * mount.usedBytes / usable, 'f', 1) : QString("-"));
+            mountTable->item(i, MountInodesUsedColumn)->setText(
+                mount.totalInodes > 0 ? QString::number(mount.totalInodes - mount.freeInodes) : QString("-"));
+            mountTable->item(i, MountInodesFreeColumn)->setText(
+                mount.totalInodes > 0 ? QString::number(mount.freeInodes) : QString("-"));
+        }
+    }
+
+    void updatePressure(const PressureInfo &info)
+    {
+        lastPressure = info;
+        QString text = PressureStall::getPressureString(info);
+        if (!lastStall.isEmpty()) {
+            text += QString("\nLast stall: %1").arg(lastStall);
+        }
+        ioPressureLabel->setText(text);
     }
 
 private:
+    // statvfs every 10 s, mount table changes are picked up as they happen
+    static constexpr int MountCadenceTicks = 10;
+
+    enum MountColumn {
+        MountPointColumn,
+        MountDeviceColumn,
+        MountTypeColumn,
+        MountUsedColumn,
+        MountFreeColumn,
+        MountSizeColumn,
+        MountPercentColumn,
+        MountInodesUsedColumn,
+        MountInodesFreeColumn,
+        MountColumnCount
+    };
+
+    static QString formatBytes(quint64 bytes)
+    {
+        const double gb = bytes / (1024.0 * 1024.0 * 1024.0);
+        if (gb >= 1.0) {
+            return QString::number(gb, 'f', 2) + " GB";
+        }
+        return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+    }
+
+    struct DeviceGraphs
+    {
+        QWidget *page = nullptr;
+        UsageGraph *readGraph = nullptr;
+        UsageGraph *writeGraph = nullptr;
+        UsageGraph *readIopsGraph = nullptr;
+        UsageGraph *writeIopsGraph = nullptr;
+    };
+
+    void addDevice(const DeviceStats &device, DeviceGraphs &graphs)
+    {
+        const QString text = device.label == device.name
+                                 ? QString("%1 (%2)").arg(device.name, DiskInfo::kindName(device.kind))
+                                 : QString("%1 [%2] (%3)").arg(device.label, device.name, DiskInfo::kindName(device.kind));
+        devicePages->addPage(device.name, text);
+        QGridLayout *graphLayout = new QGridLayout(graphs.page);
+        graphLayout->setContentsMargins(0, 0, 0, 0);
+        graphLayout->setSpacing(20); // Add some spacing between graphs
+
+        graphs.readGraph = new UsageGraph("Read Throughput", 0.0, 3000.00, "MB/s", graphs.page);
+        graphs.readGraph->setMinimumHeight(250);
+        graphs.readGraph->setMaximumWidth(400); // Prevent horizontal stretching
+        graphLayout->addWidget(graphs.readGraph, 0, 0);
+
+        graphs.writeGraph = new UsageGraph("Write Throughput", 0.0, 3000.00, "MB/s", graphs.page);
+        graphs.writeGraph->setMinimumHeight(250);
+        graphs.writeGraph->setMaximumWidth(400); // Prevent horizontal stretching
+        graphLayout->addWidget(graphs.writeGraph, 0, 1);
+
+        // Completed requests per second, from the counter rates rather than the raw totals
+        graphs.readIopsGraph = new UsageGraph("Read IOPS", 0.0, 10000.0, " IOPS", graphs.page);
+        graphs.readIopsGraph->setMinimumHeight(250);
+        graphs.readIopsGraph->setMaximumWidth(400);
+        graphLayout->addWidget(graphs.readIopsGraph, 1, 0);
+
+        graphs.writeIopsGraph = new UsageGraph("Write IOPS", 0.0, 10000.0, " IOPS", graphs.page);
+        graphs.writeIopsGraph->setMinimumHeight(250);
+        graphs.writeIopsGraph->setMaximumWidth(400);
+        graphLayout->addWidget(graphs.writeIopsGraph, 1, 1);
+    }
+
     QLabel *diskUsageLabel;
+    QLabel *diskLatencyLabel;
+    QLabel *ioPressureLabel;
+    PressureInfo lastPressure;
+    QString lastStall;
+    PressureStall *ioPressure;
     DiskInfo *diskMonitor;
-    UsageGraph *readGraph;
-    UsageGraph *writeGraph;
+    GraphPageStack<DeviceGraphs> *devicePages;
+    DiskStats lastStats;
+    QTableWidget *mountTable;
+    MountMonitor *mountMonitor;
     QPushButton *backgroundColor_btn;
     QPushButton *textColor_btn;
     QPushButton *applyAllPages_btn;
@@ -566,18 +1057,117 @@ public:
             "QLabel{ color: white; font-size: 18px; font-weight: 500; margin-bottom: 20px;}");
         layout->addWidget(title);
 
-        //table for all processes
-        processTable = new QTableWidget(this);
-        processTable->setColumnCount(5);
-        processTable->setHorizontalHeaderLabels({"PID", "Name", "CPU %", "RAM", "I/O"});
+        filterEdit = new QLineEdit(this);
+        filterEdit->setPlaceholderText("Filter by name or PID");
+        filterEdit->setClearButtonEnabled(true);
+        filterEdit->setStyleSheet(
+            "QLineEdit { background-color: #2d2d2d; color: white; border: 1px solid #3d3d3d; padding: 4px; }");
+
+        // Top-N modes only read the io file for the processes that make the cut
+        modeCombo = new QComboBox(this);
+        modeCombo->addItem("Top 50 by CPU", ProcessInfo::ByCpu);
+        modeCombo->addItem("Top 50 by RAM", ProcessInfo::ByRam);
+        modeCombo->addItem("Top 50 by I/O", ProcessInfo::ByIo);
+        modeCombo->addItem("All processes", AllProcesses);
+        modeCombo->addItem("All by disk I/O (iotop)", AllByIoRate);
+        modeCombo->setStyleSheet(
+            "QComboBox { background-color: #2d2d2d; color: white; border: 1px solid #3d3d3d; padding: 4px; }");
+
+        treeToggle = new QPushButton("Tree View");
+        treeToggle->setCheckable(true);
+        treeToggle->setStyleSheet("QPushButton { color: white; font-size: 15px; max-width: 250px; border: 1px solid white; border-radius: 2px}");
+
+        QWidget *filterRow = new QWidget(this);
+        filterRow->setMaximumWidth(820);
+        QHBoxLayout *filterLayout = new QHBoxLayout(filterRow);
+        filterLayout->setContentsMargins(0, 0, 0, 0);
+        filterLayout->addWidget(filterEdit, 1);
+        filterLayout->addWidget(modeCombo);
+        filterLayout->addWidget(treeToggle);
+        layout->addWidget(filterRow);
+
+        //table for all processes, rows are diffed by PID so selection and scroll survive updates
+        processModel = new ProcessTableModel(this);
+        proxyModel = new ProcessFilterProxyModel(this);
+        proxyModel->setSourceModel(processModel);
+        connect(filterEdit, &QLineEdit::textChanged, proxyModel, &ProcessFilterProxyModel::setFilterText);
+
+        processTable = new QTableView(this);
+        processTable->setModel(proxyModel);
+        processTable->setSortingEnabled(true);
+        processTable->sortByColumn(ProcessTableModel::CpuColumn, Qt::DescendingOrder);
+        processTable->verticalHeader()->hide();
         processTable->horizontalHeader()->setStretchLastSection(true);
         processTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        processTable->setSelectionMode(QAbstractItemView::SingleSelection);
         processTable->setStyleSheet(
-            "QTableWidget { background-color: #2d2d2d; color: white; }"
+            "QAbstractItemView { background-color: #2d2d2d; color: white; }"
+            "QHeaderView::section { background-color: #3d3d3d; color: white; padding: 5px; }");
+
+        // Tree of the same snapshot by ppid, usage rolled up per subtree
+        treeModel = new ProcessTreeModel(this);
+        treeProxy = new QSortFilterProxyModel(this);
+        treeProxy->setSourceModel(treeModel);
+        treeProxy->setSortRole(ProcessTreeModel::SortRole);
+        treeProxy->setFilterKeyColumn(ProcessTreeModel::NameColumn);
+        treeProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+        treeProxy->setRecursiveFilteringEnabled(true);
+        connect(filterEdit, &QLineEdit::textChanged, treeProxy, &QSortFilterProxyModel::setFilterFixedString);
+
+        processTree = new QTreeView(this);
+        processTree->setModel(treeProxy);
+        processTree->setSortingEnabled(true);
+        processTree->sortByColumn(ProcessTreeModel::TreeCpuColumn, Qt::DescendingOrder);
+        processTree->header()->setStretchLastSection(true);
+        processTree->setSelectionBehavior(QAbstractItemView::SelectRows);
+        processTree->setSelectionMode(QAbstractItemView::SingleSelection);
+        processTree->setStyleSheet(
+            "QAbstractItemView { background-color: #2d2d2d; color: white; }"
             "QHeaderView::section { background-color: #3d3d3d; color: white; padding: 5px; }");
 
-        processTable->setMaximumWidth(820);
-        layout->addWidget(processTable);
+        viewStack = new QStackedWidget(this);
+        viewStack->addWidget(processTable);
+        viewStack->addWidget(processTree);
+        viewStack->setMaximumWidth(820);
+        layout->addWidget(viewStack);
+
+        // Threads of the selected process, its task directory is only read while it is selected
+        threadTitle = new QLabel("Threads");
+        threadTitle->setStyleSheet("QLabel { color: white; font-size: 15px; font-weight: 500; }");
+        layout->addWidget(threadTitle);
+
+        threadTable = new QTableWidget(this);
+        threadTable->setColumnCount(5);
+        threadTable->setHorizontalHeaderLabels({"TID", "Name", "State", "CPU %", "Last CPU"});
+        threadTable->verticalHeader()->hide();
+        threadTable->horizontalHeader()->setStretchLastSection(true);
+        threadTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        threadTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        threadTable->setStyleSheet(
+            "QAbstractItemView { background-color: #2d2d2d; color: white; }"
+            "QHeaderView::section { background-color: #3d3d3d; color: white; padding: 5px; }");
+        threadTable->setMaximumWidth(820);
+        threadTable->setMaximumHeight(180);
+        layout->addWidget(threadTable);
+
+        // Short-lived processes stay visible here after they exit
+        QLabel *exitedTitle = new QLabel("Recently Exited");
+        exitedTitle->setStyleSheet("QLabel { color: white; font-size: 15px; font-weight: 500; }");
+        layout->addWidget(exitedTitle);
+
+        exitTable = new QTableWidget(this);
+        exitTable->setColumnCount(6);
+        exitTable->setHorizontalHeaderLabels({"PID", "Name", "CPU Time", "I/O", "Lifetime", "Exited"});
+        exitTable->verticalHeader()->hide();
+        exitTable->horizontalHeader()->setStretchLastSection(true);
+        exitTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        exitTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        exitTable->setStyleSheet(
+            "QAbstractItemView { background-color: #2d2d2d; color: white; }"
+            "QHeaderView::section { background-color: #3d3d3d; color: white; padding: 5px; }");
+        exitTable->setMaximumWidth(820);
+        exitTable->setMaximumHeight(180);
+        layout->addWidget(exitTable);
 
         // Change background color button
         backgroundColor_btn = new QPushButton("Change Background Color");
@@ -615,45 +1205,355 @@ public:
             }
         });
 
-        processMonitor = new ProcessInfo(this);
+        processMonitor = new ProcessInfo();
+        processMonitor->setTopN(TopCount, ProcessInfo::ByCpu);
         connect(processMonitor,
                 &ProcessInfo::processesUpdated,
                 this,
                 &ProcessWidget::updateProcesses);
+        connect(processMonitor, &ProcessInfo::exitLogUpdated, this, &ProcessWidget::updateExitLog);
+        // Always, so the tree does not keep processes that exited while the table was shown
+        connect(processMonitor, &ProcessInfo::processesExited, treeModel, &ProcessTreeModel::removeProcesses);
+        connect(processMonitor, &ProcessInfo::threadsUpdated, this, &ProcessWidget::updateThreads);
+        connect(processTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+                [this](const QModelIndex &current) { watchProcess(current, ProcessTableModel::PidColumn); });
+        connect(processTree->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+                [this](const QModelIndex &current) { watchProcess(current, ProcessTreeModel::PidColumn); });
+        connect(modeCombo, &QComboBox::currentIndexChanged, this, &ProcessWidget::setMode);
+        connect(treeToggle, &QPushButton::toggled, this, &ProcessWidget::setTreeView);
+        SamplerThread::instance()->adopt(processMonitor);
 
         setStyleSheet("QWidget { background-color: #1e1e1e;}");
     }
+
+    // For wiring to other collectors only, the monitor lives on the sampler thread
+    ProcessInfo *monitor() const { return processMonitor; }
+
 private slots:
     void updateProcesses(std::vector<ProcessUsage> processes)
     {
-        processTable->setRowCount(processes.size());
-        for (size_t i = 0; i < processes.size(); ++i) {
-            const ProcessUsage &proc = processes[i];
-            processTable->setItem(i, 0, new QTableWidgetItem(QString::number(proc.PID)));
-            processTable->setItem(i, 1, new QTableWidgetItem(proc.name));
-            processTable->setItem(i,
-                                  2,
-                                  new QTableWidgetItem(QString::number(proc.cpuUsage, 'f', 2)));
-            processTable->setItem(i,
-                                  3,
-                                  new QTableWidgetItem(QString::number(proc.ramUsage, 'f', 2)
-                                                       + " MB"));
-            processTable->setItem(i,
-                                  4,
-                                  new QTableWidgetItem(
-                                      "Bytes Read: " + QString("%1").arg(proc.bytesRead)
-                                      + " Bytes Written: " + QString("%1").arg(proc.bytesWritten)));
+        processModel->setProcesses(processes);
+        if (treeToggle->isChecked()) {
+            treeModel->setProcesses(processes);
+        }
+    }
+
+    void setTreeView(bool enabled)
+    {
+        viewStack->setCurrentWidget(enabled ? static_cast<QWidget *>(processTree) : processTable);
+        if (enabled) {
+            watchProcess(processTree->currentIndex(), ProcessTreeModel::PidColumn);
+        } else {
+            watchProcess(processTable->currentIndex(), ProcessTableModel::PidColumn);
+        }
+
+        // The tree needs every process, top-N modes would leave most of it orphaned
+        modeCombo->setEnabled(!enabled);
+        if (enabled) {
+            applyTopN(0, ProcessInfo::ByCpu);
+        } else {
+            setMode(modeCombo->currentIndex());
+        }
+    }
+
+    void applyTopN(int count, ProcessInfo::SortKey sortKey)
+    {
+        // The monitor lives on the sampler thread, hand the change over to it
+        ProcessInfo *monitor = processMonitor;
+        QMetaObject::invokeMethod(monitor, [monitor, count, sortKey]() {
+            monitor->setTopN(count, sortKey);
+        }, Qt::QueuedConnection);
+    }
+
+    void updateExitLog(const QVector<ExitedProcess> &log)
+    {
+        // Newest first
+        exitTable->setRowCount(log.size());
+        for (int i = 0; i < log.size(); ++i) {
+            const ExitedProcess &proc = log[log.size() - 1 - i];
+            exitTable->setItem(i, 0, new QTableWidgetItem(QString::number(proc.PID)));
+            exitTable->setItem(i, 1, new QTableWidgetItem(proc.name));
+            exitTable->setItem(i, 2, new QTableWidgetItem(QString::number(proc.cpuSeconds, 'f', 2) + " s"));
+            exitTable->setItem(i,
+                               3,
+                               new QTableWidgetItem("Read: " + QString::number(proc.bytesRead)
+                                                    + " Written: " + QString::number(proc.bytesWritten)));
+            exitTable->setItem(i, 4, new QTableWidgetItem(QString::number(proc.lifetime, 'f', 1) + " s"));
+            exitTable->setItem(i,
+                               5,
+                               new QTableWidgetItem(
+                                   QDateTime::fromMSecsSinceEpoch(proc.exitTime).toString("HH:mm:ss")));
+        }
+    }
+
+    void watchProcess(const QModelIndex &current, int pidColumn)
+    {
+        // Both models sort the PID column on the PID itself, the column differs between them
+        const int pid = current.isValid()
+                            ? current.sibling(current.row(), pidColumn).data(ProcessTableModel::SortRole).toInt()
+                            : 0;
+        if (pid == watchedPid) {
+            return;
+        }
+        watchedPid = pid;
+        threadTitle->setText(pid > 0 ? QString("Threads of PID %1").arg(pid) : QString("Threads"));
+        threadTable->setRowCount(0);
+
+        ProcessInfo *monitor = processMonitor;
+        QMetaObject::invokeMethod(monitor, [monitor, pid]() {
+            monitor->setWatchedPid(pid);
+        }, Qt::QueuedConnection);
+    }
+
+    void updateThreads(int pid, const QVector<ThreadUsage> &threads)
+    {
+        // Results for a PID that was already deselected are still queued
+        if (pid != watchedPid) {
+            return;
+        }
+        if (threads.isEmpty()) {
+            threadTitle->setText(QString("Threads of PID %1 (exited)").arg(pid));
+        }
+
+        // Items are reused across updates, only the texts change
+        const int previousRows = threadTable->rowCount();
+        threadTable->setRowCount(threads.size());
+        for (int i = 0; i < threads.size(); ++i) {
+            const ThreadUsage &thread = threads[i];
+            if (i >= previousRows) {
+                for (int column = 0; column < threadTable->columnCount(); ++column) {
+                    threadTable->setItem(i, column, new QTableWidgetItem());
+                }
+            }
+            threadTable->item(i, 0)->setText(QString::number(thread.tid));
+            threadTable->item(i, 1)->setText(thread.name);
+            threadTable->item(i, 2)->setText(QString(QChar(thread.state)));
+            threadTable->item(i, 3)->setText(QString::number(thread.cpuUsage, 'f', 1));
+            threadTable->item(i, 4)->setText(QString::number(thread.lastCpu));
+        }
+    }
+
+    void setMode(int index)
+    {
+        const int key = modeCombo->itemData(index).toInt();
+        const int count = key < 0 ? 0 : TopCount;
+
+        // iotop view, full table so every process has its io read and a rate each tick
+        if (key == AllByIoRate) {
+            processTable->sortByColumn(ProcessTableModel::IoColumn, Qt::DescendingOrder);
+        }
+        const ProcessInfo::SortKey sortKey = key < 0 ? ProcessInfo::ByCpu
+                                                     : static_cast<ProcessInfo::SortKey>(key);
+
+        applyTopN(count, sortKey);
+
+        if (sortKey == ProcessInfo::ByRam) {
+            processTable->sortByColumn(ProcessTableModel::RamColumn, Qt::DescendingOrder);
+        } else if (sortKey == ProcessInfo::ByIo && count > 0) {
+            processTable->sortByColumn(ProcessTableModel::IoColumn, Qt::DescendingOrder);
+        } else if (count > 0) {
+            processTable->sortByColumn(ProcessTableModel::CpuColumn, Qt::DescendingOrder);
         }
     }
 
 private:
-    QTableWidget *processTable;
+    static constexpr int TopCount = 50;
+    // Mode combo entries that are not a ProcessInfo::SortKey
+    static constexpr int AllProcesses = -1;
+    static constexpr int AllByIoRate = -2;
+
+    QComboBox *modeCombo;
+    QLineEdit *filterEdit;
+    ProcessTableModel *processModel;
+    ProcessFilterProxyModel *proxyModel;
+    QTableView *processTable;
+    QPushButton *treeToggle;
+    ProcessTreeModel *treeModel;
+    QSortFilterProxyModel *treeProxy;
+    QTreeView *processTree;
+    QStackedWidget *viewStack;
+    QTableWidget *exitTable;
+    QLabel *threadTitle;
+    QTableWidget *threadTable;
+    int watchedPid = 0;
     ProcessInfo *processMonitor;
     QPushButton *backgroundColor_btn;
     QPushButton *textColor_btn;
     QPushButton *applyAllPages_btn;
 };
 
+// cgroup v2 hierarchy with per-cgroup usage, processes are listed under the cgroup they are in
+class CgroupWidget : public QWidget
+{
+public:
+    CgroupWidget(QWidget *parent = nullptr)
+        : QWidget(parent)
+    {
+        QVBoxLayout *layout = new QVBoxLayout(this);
+        layout->setContentsMargins(24, 24, 24, 24);
+
+        QLabel *title = new QLabel("Cgroups");
+        title->setAlignment(Qt::AlignCenter);
+        title->setStyleSheet(
+            "QLabel{ color: white; font-size: 18px; font-weight: 500; margin-bottom: 20px;}");
+        layout->addWidget(title);
+
+        cgroupTree = new QTreeWidget(this);
+        cgroupTree->setColumnCount(ColumnCount);
+        cgroupTree->setHeaderLabels({"Cgroup", "Tasks", "CPU %", "Memory", "Anon / File", "Read", "Write", "CPU Pressure"});
+        cgroupTree->header()->setStretchLastSection(true);
+        cgroupTree->setSelectionBehavior(QAbstractItemView::SelectRows);
+        cgroupTree->setSelectionMode(QAbstractItemView::SingleSelection);
+        cgroupTree->setStyleSheet(
+            "QAbstractItemView { background-color: #2d2d2d; color: white; }"
+            "QHeaderView::section { background-color: #3d3d3d; color: white; padding: 5px; }");
+        cgroupTree->setMaximumWidth(820);
+        layout->addWidget(cgroupTree);
+
+        // Change background color button
+        backgroundColor_btn = new QPushButton("Change Background Color");
+        backgroundColor_btn->setStyleSheet("QPushButton { color: white; font-size: 15px; max-width: 250px; border: 1px solid white; border-radius: 2px}");
+        layout->addWidget(backgroundColor_btn);
+
+        // Change text color button
+        textColor_btn = new QPushButton("Change Content Color");
+        textColor_btn->setStyleSheet("QPushButton { color: white; font-size: 15px; max-width: 250px; border: 1px solid white; border-radius: 2px}");
+        layout->addWidget(textColor_btn);
+
+        // Apply page styling to all pages button
+        applyAllPages_btn = new QPushButton("Apply Styling To All Pages");
+        applyAllPages_btn->setStyleSheet("QPushButton { color: white; font-size: 15px; max-width: 250px; border: 1px solid white; border-radius: 2px}");
+        layout->addWidget(applyAllPages_btn);
+
+        // Connects background color button to color dialog box (color wheel)
+        connect(backgroundColor_btn, &QPushButton::clicked, this, [this]() {
+            ColorUtils::setBackgroundColorDialog(this);
+        });
+
+        // Connects background color button to color dialog box (color wheel)
+        connect(textColor_btn, &QPushButton::clicked, this, [this]() {
+            ColorUtils::setTextColorDialog(this);
+        });
+
+        connect(applyAllPages_btn, &QPushButton::clicked, this, [this]() {
+            QStackedWidget* stack = qobject_cast<QStackedWidget*>(parentWidget());
+            if (stack) {
+                QList<QWidget*> pages;
+                for (int i = 0; i < stack->count(); ++i) {
+                    pages.append(stack->widget(i));
+                }
+                ColorUtils::setAllStyles(this, pages);
+            }
+        });
+
+        // Every cgroup's accounting files, every other tick is plenty for this page
+        cgroupMonitor = new CgroupMonitor();
+        connect(cgroupMonitor, &CgroupMonitor::cgroupsUpdated, this, &CgroupWidget::updateCgroups);
+        SamplerThread::instance()->adopt(cgroupMonitor, 2);
+
+        setStyleSheet("QWidget { background-color: #1e1e1e;}");
+    }
+
+    // For wiring to other collectors only, the monitor lives on the sampler thread
+    CgroupMonitor *monitor() const { return cgroupMonitor; }
+
+private slots:
+    void updateCgroups(const QVector<CgroupUsage> &cgroups)
+    {
+        // Items are kept by path so expansion and selection survive updates
+        ++generation;
+        for (const CgroupUsage &cgroup : cgroups) {
+            CgroupItem &entry = items[cgroup.path];
+            if (!entry.item) {
+                if (cgroup.parentPath.isEmpty()) {
+                    entry.item = new QTreeWidgetItem(cgroupTree);
+                    entry.item->setExpanded(true);
+                } else {
+                    // Parents are listed before their children
+                    entry.item = new QTreeWidgetItem(items.value(cgroup.parentPath).item);
+                }
+                entry.item->setText(NameColumn, cgroup.parentPath.isEmpty()
+                                                    ? cgroup.path
+                                                    : cgroup.path.mid(cgroup.path.lastIndexOf('/') + 1));
+                entry.item->setToolTip(NameColumn, cgroup.path);
+            }
+            entry.generation = generation;
+
+            QTreeWidgetItem *item = entry.item;
+            item->setText(TasksColumn, QString::number(cgroup.processes.size()));
+            item->setText(CpuColumn, QString::number(cgroup.cpuUsage, 'f', 1));
+            item->setText(MemoryColumn, QString::number(cgroup.memoryMB, 'f', 1) + " MB");
+            item->setText(AnonFileColumn,
+                          QString("%1 / %2 MB").arg(cgroup.anonMB, 0, 'f', 1).arg(cgroup.fileMB, 0, 'f', 1));
+            item->setText(ReadColumn, CounterRate::formatRate(cgroup.readRate));
+            item->setText(WriteColumn, CounterRate::formatRate(cgroup.writeRate));
+            item->setText(PressureColumn, QString::number(cgroup.cpuPressure, 'f', 2) + "%");
+
+            updateProcesses(entry, cgroup.processes);
+        }
+
+        // Children go first, a cgroup can only be removed once its children are
+        QStringList removed;
+        for (auto it = items.cbegin(); it != items.cend(); ++it) {
+            if (it->generation != generation) {
+                removed.append(it.key());
+            }
+        }
+        std::sort(removed.begin(), removed.end(), [](const QString &a, const QString &b) {
+            return a.size() > b.size();
+        });
+        for (const QString &path : removed) {
+            delete items.take(path).item;
+        }
+    }
+
+private:
+    enum Column {
+        NameColumn,
+        TasksColumn,
+        CpuColumn,
+        MemoryColumn,
+        AnonFileColumn,
+        ReadColumn,
+        WriteColumn,
+        PressureColumn,
+        ColumnCount
+    };
+
+    struct CgroupItem
+    {
+        QTreeWidgetItem *item = nullptr;
+        QHash<int, QTreeWidgetItem *> processes;
+        quint64 generation = 0;
+    };
+
+    void updateProcesses(CgroupItem &entry, const QVector<CgroupProcess> &processes)
+    {
+        QHash<int, QTreeWidgetItem *> current;
+        current.reserve(processes.size());
+        for (const CgroupProcess &proc : processes) {
+            QTreeWidgetItem *item = entry.processes.take(proc.pid);
+            if (!item) {
+                item = new QTreeWidgetItem(entry.item);
+                item->setForeground(NameColumn, QColor("#9ca3af"));
+            }
+            item->setText(NameColumn, QString("%1 (%2)").arg(proc.name).arg(proc.pid));
+            current.insert(proc.pid, item);
+        }
+        // Whatever is left exited or moved to another cgroup
+        qDeleteAll(entry.processes);
+        entry.processes.swap(current);
+    }
+
+    QTreeWidget *cgroupTree;
+    QHash<QString, CgroupItem> items;
+    quint64 generation = 0;
+    CgroupMonitor *cgroupMonitor;
+    QPushButton *backgroundColor_btn;
+    QPushButton *textColor_btn;
+    QPushButton *applyAllPages_btn;
+};
+
 // placeholder widget for other tab pages
 class PlaceholderWidget : public QWidget
 {
@@ -712,7 +1612,7 @@ void MainWindow::setupPerformanceSidebar()
 {
     //using a QList to store our tabs and keep index
     performanceSidebar = new QListWidget();
-    performanceSidebar->addItems({"CPU", "Memory", "Disk", "Network", "Processes"});
+    performanceSidebar->addItems({"CPU", "Memory", "Disk", "Network", "Processes", "Cgroups"});
     performanceSidebar->setMinimumWidth(140);
     performanceSidebar->setMaximumWidth(180);
     performanceSidebar->setCurrentRow(0); // Start with CPU selected
@@ -725,11 +1625,26 @@ void MainWindow::setupContentStack()
     contentStack = new QStackedWidget();
 
     // Add CPU widget with actual monitoring
-    contentStack->addWidget(new CpuWidget());
+    CpuWidget *cpuWidget = new CpuWidget();
+    ProcessWidget *processWidget = new ProcessWidget();
+    CgroupWidget *cgroupWidget = new CgroupWidget();
+    contentStack->addWidget(cpuWidget);
     contentStack->addWidget(new RamWidget());
     contentStack->addWidget(new DiskWidget());
     contentStack->addWidget(new NetWidget());
-    contentStack->addWidget(new ProcessWidget());
+    contentStack->addWidget(processWidget);
+    contentStack->addWidget(cgroupWidget);
+
+    // CPU page takes its process/thread totals from the process scan instead of walking /proc again
+    connect(processWidget->monitor(),
+            &ProcessInfo::totalsUpdated,
+            cpuWidget->monitor(),
+            &CpuMonitorUsage::setProcessTotals);
+    // Same for the cgroup page's process membership
+    connect(processWidget->monitor(),
+            &ProcessInfo::processListChanged,
+            cgroupWidget->monitor(),
+            &CgroupMonitor::setProcesses);
 
     // Add placeholder widgets for other performance tabs
     QStringList tabs = {"Disk", "Processes"};
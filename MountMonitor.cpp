@@ -0,0 +1,194 @@
+#include "MountMonitor.h"
+#include <QDebug>
+#include <QFile>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+MountMonitor::MountMonitor(QObject *parent)
+    : QObject(parent)
+    , m_fd(::open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC))
+    , m_notifier(nullptr)
+    , m_remote(std::make_shared<RemoteResults>())
+{
+    if (m_fd < 0) {
+        qWarning() << "Cannot open /proc/self/mountinfo:" << strerror(errno);
+    } else {
+        // Mount table changes are reported as POLLPRI, which QSocketNotifier exposes as Exception
+        m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Exception, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &MountMonitor::onMountsChanged);
+    }
+
+    // Posted events move with the object, so the first read runs on the thread it is adopted onto
+    QMetaObject::invokeMethod(this, &MountMonitor::onMountsChanged, Qt::QueuedConnection);
+}
+
+MountMonitor::~MountMonitor()
+{
+    delete m_notifier;
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+bool MountMonitor::isPseudoFilesystem(const QByteArray &fsType)
+{
+    // Kernel interfaces and memory-backed filesystems, none of them has a disk behind it
+    static const QSet<QByteArray> pseudo = {
+        "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs", "devpts",
+        "devtmpfs", "efivarfs", "fusectl", "hugetlbfs", "mqueue", "nsfs", "proc", "pstore",
+        "ramfs", "rpc_pipefs", "securityfs", "selinuxfs", "sysfs", "tmpfs", "tracefs",
+    };
+    return pseudo.contains(fsType) || fsType.startsWith("fuse.gvfs") || fsType == "fuse.portal";
+}
+
+bool MountMonitor::mayBlock(const QString &fsType)
+{
+    // Filesystems served by a remote host or a userspace daemon, either can stop answering
+    static const QSet<QString> remote = {
+        "9p", "afs", "ceph", "cifs", "glusterfs", "lustre", "ncpfs", "nfs", "nfs4", "smb3", "smbfs",
+    };
+    return remote.contains(fsType) || fsType.startsWith("fuse");
+}
+
+QByteArray MountMonitor::unescape(const QByteArray &field)
+{
+    // Space, tab, newline and backslash come as \040, \011, \012 and \134
+    QByteArray result;
+    result.reserve(field.size());
+    for (int i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 3 < field.size()) {
+            bool ok = false;
+            const int value = field.mid(i + 1, 3).toInt(&ok, 8);
+            if (ok) {
+                result.append(static_cast<char>(value));
+                i += 3;
+                continue;
+            }
+        }
+        result.append(field[i]);
+    }
+    return result;
+}
+
+void MountMonitor::readMounts()
+{
+    m_mounts.clear();
+    if (m_fd < 0) {
+        return;
+    }
+
+    QByteArray content;
+    char buffer[16384];
+    lseek(m_fd, 0, SEEK_SET);
+    for (;;) {
+        const ssize_t n = ::read(m_fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        content.append(buffer, n);
+    }
+
+    // 36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    QSet<QByteArray> devices;
+    const QList<QByteArray> lines = content.split('\n');
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.split(' ');
+        const int separator = fields.indexOf("-");
+        if (separator < 6 || separator + 2 >= fields.size()) {
+            continue;
+        }
+        const QByteArray &fsType = fields[separator + 1];
+        if (isPseudoFilesystem(fsType)) {
+            continue;
+        }
+        // Bind mounts and subvolume mounts of a device already listed show the same capacity
+        if (devices.contains(fields[2])) {
+            continue;
+        }
+        devices.insert(fields[2]);
+
+        Mount mount;
+        mount.path = unescape(fields[4]);
+        mount.mountPoint = QFile::decodeName(mount.path);
+        mount.source = QString::fromUtf8(unescape(fields[separator + 2]));
+        mount.fsType = QString::fromLatin1(fsType);
+        mount.readOnly = fields[5].split(',').contains("ro");
+        m_mounts.append(mount);
+    }
+}
+
+void MountMonitor::onMountsChanged()
+{
+    // Show a new or removed mount right away rather than on the next slow tick
+    readMounts();
+    {
+        QMutexLocker locker(&m_remote->mutex);
+        for (auto it = m_remote->answers.begin(); it != m_remote->answers.end();) {
+            const bool listed = std::any_of(m_mounts.cbegin(), m_mounts.cend(),
+                                            [&](const Mount &mount) { return mount.path == it.key(); });
+            it = listed ? std::next(it) : m_remote->answers.erase(it);
+        }
+    }
+    sample(SampleTick::now());
+}
+
+bool MountMonitor::statRemote(const QByteArray &path, struct statvfs &buf)
+{
+    QMutexLocker locker(&m_remote->mutex);
+    if (!m_remote->pending.contains(path)) {
+        // One query per mount at a time, a mount that hangs costs a single stuck thread
+        m_remote->pending.insert(path);
+        std::thread([results = m_remote, path]() {
+            struct statvfs answer;
+            const bool ok = statvfs(path.constData(), &answer) == 0;
+            QMutexLocker locker(&results->mutex);
+            results->pending.remove(path);
+            if (ok) {
+                results->answers.insert(path, answer);
+            } else {
+                results->answers.remove(path);
+            }
+        }).detach();
+    }
+
+    // The answer from an earlier sample, nothing until the first query returns
+    const auto answer = m_remote->answers.constFind(path);
+    if (answer == m_remote->answers.cend()) {
+        return false;
+    }
+    buf = *answer;
+    return true;
+}
+
+void MountMonitor::sample(const SampleTick &tick)
+{
+    QVector<MountUsage> mounts;
+    mounts.reserve(m_mounts.size());
+    for (const Mount &mount : m_mounts) {
+        struct statvfs buf;
+        const bool ok = mayBlock(mount.fsType) ? statRemote(mount.path, buf)
+                                               : statvfs(mount.path.constData(), &buf) == 0;
+        if (!ok || buf.f_blocks == 0) {
+            continue;
+        }
+
+        MountUsage usage;
+        usage.mountPoint = mount.mountPoint;
+        usage.source = mount.source;
+        usage.fsType = mount.fsType;
+        usage.readOnly = mount.readOnly;
+        usage.totalBytes = static_cast<quint64>(buf.f_blocks) * buf.f_frsize;
+        usage.freeBytes = static_cast<quint64>(buf.f_bavail) * buf.f_frsize;
+        usage.usedBytes = static_cast<quint64>(buf.f_blocks - buf.f_bfree) * buf.f_frsize;
+        usage.totalInodes = buf.f_files;
+        usage.freeInodes = buf.f_ffree;
+        mounts.append(usage);
+    }
+
+    emit mountsUpdated(mounts, tick);
+}
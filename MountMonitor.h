@@ -0,0 +1,80 @@
+#ifndef MOUNTMONITOR_H
+#define MOUNTMONITOR_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <sys/statvfs.h>
+#include "SampleScheduler.h"
+
+class QSocketNotifier;
+
+// Capacity of one mounted filesystem from statvfs
+struct MountUsage
+{
+    QString mountPoint;
+    QString source;      // device or remote the filesystem comes from
+    QString fsType;
+    bool readOnly;
+    quint64 totalBytes;
+    quint64 freeBytes;   // available to unprivileged users, as df reports it
+    quint64 usedBytes;   // total minus everything free, including the root reserve
+    quint64 totalInodes; // 0 where inodes are allocated on demand, e.g. btrfs
+    quint64 freeInodes;
+};
+
+// Keeps the list of real mounts from /proc/self/mountinfo and their usage. The list is read again
+// only when the kernel flags the mount table as changed, which mountinfo reports as POLLPRI|POLLERR.
+// statvfs runs on every sample, so this collector should be adopted with a slow cadence. A hard
+// network mount that lost its server blocks statvfs until it comes back, so network and FUSE
+// filesystems are queried on threads of their own and never hold up the sampler thread.
+class MountMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MountMonitor(QObject *parent = nullptr);
+    ~MountMonitor();
+
+    void sample(const SampleTick &tick);
+
+signals:
+    // In mountinfo order, sent after every sample and whenever the mount table changed
+    void mountsUpdated(const QVector<MountUsage> &mounts, const SampleTick &tick);
+
+private:
+    struct Mount
+    {
+        QString mountPoint;
+        QByteArray path; // encoded for statvfs
+        QString source;
+        QString fsType;
+        bool readOnly;
+    };
+
+    // statvfs results of the mounts that may block, shared with the threads querying them
+    struct RemoteResults
+    {
+        QMutex mutex;
+        QHash<QByteArray, struct statvfs> answers; // last answer per path
+        QSet<QByteArray> pending;                  // paths whose statvfs has not returned yet
+    };
+
+    static bool isPseudoFilesystem(const QByteArray &fsType);
+    static bool mayBlock(const QString &fsType);
+    static QByteArray unescape(const QByteArray &field);
+    void readMounts();
+    void onMountsChanged();
+    bool statRemote(const QByteArray &path, struct statvfs &buf);
+
+    int m_fd;
+    QSocketNotifier *m_notifier;
+    QVector<Mount> m_mounts;
+    std::shared_ptr<RemoteResults> m_remote;
+};
+
+#endif // MOUNTMONITOR_H
@@ -3,46 +3,67 @@
 #include <QFile>
 #include <QHostAddress>
 #include <QNetworkInterface>
-#include <QTextStream>
 
 networkStats::networkStats(QObject *parent)
     : QObject(parent)
-    , current_rxBytes(0) //current CPU usage to 0.0 to start
-    , current_txBytes(0) //previous total CPU time (0 for now)
+    , m_generation(0)
+    , m_ifaceChosen(false)
     , m_firstRun(true)   //flag to skip first the reading
 {
-    m_timer = new QTimer(this); //timer object
-    //everytime timer fires, updateNetStats and getIfaceData retrieve and emit their data.
-    QString iface = "lo"; // defaults to loopback interface
-
-    QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
-    for (const QNetworkInterface &interface : interfaces) {
-        // Skips loopback interfaces
-        if (!interface.humanReadableName().contains("lo", Qt::CaseInsensitive)) {
-            iface = interface.humanReadableName();
-            break;
-        }
-    }
+    // calls update function immediately to create baseline data to compare to current data
+    updateNetStats(SampleTick::now());
+}
 
-    connect(m_timer, &QTimer::timeout, this, [this, iface]() {
-        updateNetStats(iface);
-        getIfaceData(iface);
-    });
+void networkStats::sample(const SampleTick &tick)
+{
+    //everytime the scheduler ticks, updateNetStats and getIfaceData retrieve and emit their data.
+    updateNetStats(tick);
+    getIfaceData(m_iface);
+}
 
-    //timer fires every 1 second
-    m_timer->start(1000);
+void networkStats::setInterface(const QString &interface)
+{
+    m_iface = interface;
+    m_ifaceChosen = true;
+    getIfaceData(m_iface);
+}
 
-    // calls update function immediately to create baseline data to compare to current data
-    updateNetStats(iface);
+bool networkStats::isLoopback(const QString &interface)
+{
+    // ARPHRD_LOOPBACK, the name alone is not enough ("wlo1" is wireless)
+    QFile typeFile(QString("/sys/class/net/%1/type").arg(interface));
+    if (typeFile.open(QIODevice::ReadOnly)) {
+        return typeFile.readAll().trimmed() == "772";
+    }
+    return interface == "lo";
+}
+
+double networkStats::scaleBits(double bytesPerSecond, QString &unit)
+{
+    double speed = (bytesPerSecond * 8) / 1000; // changes from bytes/sec to bits/sec, then to kbps
+    unit = "Kb";
+    if (speed >= 1000 && speed < 1000000) {
+        speed = speed / 1000;
+        unit = "Mb";
+    } else if (speed >= 1000000) {
+        speed = speed / 1000000;
+        unit = "Gb";
+    }
+    return speed;
 }
 
 void networkStats::getIfaceData(QString interface)
 {
     //Just returns the interface that was provided, as thats its name
-    ifaceName = interface;
+    ifaceName = interface.isEmpty() ? QString("All interfaces") : interface;
+    //Addresses of the previously shown interface must not linger
+    ipv4Addr.clear();
+    ipv6Addr.clear();
 
     //Determines the connection type based on the characters in the interface (unique to different connection types)
-    if (interface.contains("enp")) {
+    if (interface.isEmpty()) {
+        ifaceType = "N/A";
+    } else if (interface.contains("enp")) {
         ifaceType = "Ethernet (PCIE)";
     } else if (interface.contains("ens")) {
         ifaceType = "Ethernet (Hot-plug)";
@@ -87,55 +108,97 @@ void networkStats::getIfaceData(QString interface)
     emit updateIfaceData(ifaceName, ifaceType, ipv6Addr, ipv4Addr);
 }
 
-void networkStats::updateNetStats(QString interface)
+void networkStats::updateNetStats(const SampleTick &tick)
 {
-    //Obtains and reads in the receive and send files
-    QFile rxFile(QString("/sys/class/net/%1/statistics/rx_bytes").arg(interface));
-    QFile txFile(QString("/sys/class/net/%1/statistics/tx_bytes").arg(interface));
-
-    //Makes sure they are able to be opened
-    if (rxFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&rxFile);
-        in >> current_rxBytes;
-    }
-    if (txFile.open(QIODevice::ReadOnly)) {
-        QTextStream in(&txFile);
-        in >> current_txBytes;
+    QFile file("/proc/net/dev");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Cannot open /proc/net/dev";
+        return;
     }
+    const QByteArray content = file.readAll();
+    const qint64 readNs = CounterRate::nowNs();
+    file.close();
+    const QList<QByteArray> lines = content.split('\n');
+
+    ++m_generation;
+    NetStats stats;
+    stats.aggregate = InterfaceStats();
+    stats.aggregate.name = "All interfaces";
+
+    // Two header lines, then "  eth0: rx bytes packets errs drop fifo frame compressed multicast
+    // tx bytes packets errs drop fifo colls carrier compressed". Large counters can touch the colon.
+    for (int i = 2; i < lines.size(); ++i) {
+        const int colon = lines[i].indexOf(':');
+        if (colon < 0) {
+            continue;
+        }
+        const QList<QByteArray> values = lines[i].mid(colon + 1).simplified().split(' ');
+        if (values.size() < 16) {
+            continue;
+        }
 
-    // Defaults to byte size in kilobytes
-    QString rxSize = "Kb";
-    QString txSize = "Kb";
+        const QString name = QString::fromLatin1(lines[i].left(colon).trimmed());
+        auto state = m_interfaces.find(name);
+        if (state == m_interfaces.end()) {
+            state = m_interfaces.insert(name, InterfaceState());
+            state->loopback = isLoopback(name);
+        }
+        state->generation = m_generation;
 
-    //Skips first run to get a baseline for the next run
-    if (!m_firstRun) {
-        //Download speed
-        double rxSpeed = ((current_rxBytes - last_rxBytes) * 8)
-                         / 1000; // changes from bytes/sec to bits/sec, then to kbps
-        if (rxSpeed >= 1000 && rxSpeed < 1000000) {
-            rxSpeed = rxSpeed / 1000;
-            rxSize = "Mb";
-        } else if (rxSpeed >= 1000000) {
-            rxSpeed = rxSpeed / 1000000;
-            rxSize = "Gb";
+        static const int columns[CounterCount] = {0, 1, 2, 3, 8, 9, 10, 11};
+        CounterRate *counters = state->counters;
+        for (int counter = 0; counter < CounterCount; ++counter) {
+            counters[counter].update(values[columns[counter]].toULongLong(), readNs);
         }
 
-        //Upload speed
-        double txSpeed = ((current_txBytes - last_txBytes) * 8) / 1000;
-        if (txSpeed >= 1000 && txSpeed < 1000000) {
-            txSpeed = txSpeed / 1000;
-            txSize = "Mb";
-        } else if (txSpeed >= 1000000) {
-            txSpeed = txSpeed / 1000000;
-            txSize = "Gb";
+        InterfaceStats iface;
+        iface.name = name;
+        iface.loopback = state->loopback;
+        iface.rxBytes = counters[RxBytes].value();
+        iface.txBytes = counters[TxBytes].value();
+        iface.rxBytesRate = counters[RxBytes].rate();
+        iface.txBytesRate = counters[TxBytes].rate();
+        iface.rxPacketsRate = counters[RxPackets].rate();
+        iface.txPacketsRate = counters[TxPackets].rate();
+        iface.rxErrorsRate = counters[RxErrors].rate();
+        iface.txErrorsRate = counters[TxErrors].rate();
+        iface.rxDropsRate = counters[RxDrops].rate();
+        iface.txDropsRate = counters[TxDrops].rate();
+        stats.interfaces.append(iface);
+
+        if (!iface.loopback) {
+            InterfaceStats &total = stats.aggregate;
+            total.rxBytes += iface.rxBytes;
+            total.txBytes += iface.txBytes;
+            total.rxBytesRate += iface.rxBytesRate;
+            total.txBytesRate += iface.txBytesRate;
+            total.rxPacketsRate += iface.rxPacketsRate;
+            total.txPacketsRate += iface.txPacketsRate;
+            total.rxErrorsRate += iface.rxErrorsRate;
+            total.txErrorsRate += iface.txErrorsRate;
+            total.rxDropsRate += iface.rxDropsRate;
+            total.txDropsRate += iface.txDropsRate;
         }
 
-        //Emits signal with receive and send speeds for throughput (QStrings)
-        emit updatedThroughput(rxSpeed, rxSize, txSpeed, txSize);
+        // Until the page picks one, report the first interface that is not loopback
+        if (!m_ifaceChosen && m_iface.isEmpty() && !iface.loopback) {
+            m_iface = name;
+        }
+    }
+
+    // Interfaces that went away, a new one under the same name starts from scratch
+    for (auto it = m_interfaces.begin(); it != m_interfaces.end();) {
+        if (it->generation != m_generation) {
+            it = m_interfaces.erase(it);
+        } else {
+            ++it;
+        }
     }
 
-    //Updates existing throughput info with current info
-    last_txBytes = current_txBytes;
-    last_rxBytes = current_rxBytes;
+    //Skips first run to get a baseline for the next run
+    if (!m_firstRun) {
+        stats.tick = tick;
+        emit statsUpdated(stats);
+    }
     m_firstRun = false;
 }
@@ -1,9 +1,37 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
+#include <QHash>
 #include <QObject>
 #include <QString>
-#include <QTimer>
+#include <QVector>
+#include "CounterRate.h"
+#include "SampleScheduler.h"
+
+// Counters of one interface from /proc/net/dev, rates are per second over the last interval
+struct InterfaceStats
+{
+    QString name;
+    bool loopback;
+    quint64 rxBytes;       // cumulative
+    quint64 txBytes;
+    double rxBytesRate;
+    double txBytesRate;
+    double rxPacketsRate;
+    double txPacketsRate;
+    double rxErrorsRate;
+    double txErrorsRate;
+    double rxDropsRate;
+    double txDropsRate;
+};
+
+// Snapshot handed to the widgets after every sample
+struct NetStats
+{
+    QVector<InterfaceStats> interfaces; // in /proc/net/dev order
+    InterfaceStats aggregate;           // sum over every interface except loopback
+    SampleTick tick;
+};
 
 class networkStats : public QObject
 {
@@ -15,19 +43,41 @@ public:
 
     void getIfaceData(QString interface);
 
+    void sample(const SampleTick &tick);
+
+    // Bits per second scaled to Kb, Mb or Gb, the unit is returned through unit
+    static double scaleBits(double bytesPerSecond, QString &unit);
+
+public slots:
+    // Interface whose type and addresses are reported, empty for the aggregate
+    void setInterface(const QString &interface);
+
 signals:
-    void updatedThroughput(quint64 receivedBits, QString receivedSpeed, quint64 sentBits, QString sentSpeed);
+    void statsUpdated(const NetStats &stats);
     void updateIfaceData(QString name, QString type, QString ipv6, QString ipv4);
 
-private slots:
-    void updateNetStats(QString interface);
-
 private:
-    QTimer *m_timer;
-    quint64 current_rxBytes;
-    quint64 current_txBytes;
-    quint64 last_rxBytes;
-    quint64 last_txBytes;
+    // Columns of /proc/net/dev kept per interface, receive then transmit
+    enum Counter {
+        RxBytes, RxPackets, RxErrors, RxDrops,
+        TxBytes, TxPackets, TxErrors, TxDrops,
+        CounterCount
+    };
+
+    struct InterfaceState
+    {
+        CounterRate counters[CounterCount];
+        bool loopback = false;
+        quint64 generation = 0;
+    };
+
+    void updateNetStats(const SampleTick &tick);
+    static bool isLoopback(const QString &interface);
+
+    QHash<QString, InterfaceState> m_interfaces;
+    quint64 m_generation;
+    QString m_iface;
+    bool m_ifaceChosen;
     QString ifaceName;
     QString ifaceType;
     QString ipv4Addr;
@@ -1,7 +1,8 @@
 #include "PageCustomization.h"
 #include <QRegularExpression>
 #include <QDebug>
-#include <QTableWidget>
+#include <QAbstractItemView>
+#include <QHeaderView>
 #include "UsageGraph.h"
 
 void ColorUtils::setBackgroundColorDialog(QWidget* widget)
@@ -46,8 +47,11 @@ void ColorUtils::setTextColorDialog(QWidget* widget)
         ogLabelStyles[label] = label->styleSheet();
     }
 
-    QMap<QTableWidget*, QString> ogTableStyles;
-    for (QTableWidget* table : widget->findChildren<QTableWidget*>()) {
+    QMap<QAbstractItemView*, QString> ogTableStyles;
+    for (QAbstractItemView* table : widget->findChildren<QAbstractItemView*>()) {
+        if (qobject_cast<QHeaderView*>(table)) {
+            continue;
+        }
         ogTableStyles[table] = table->styleSheet();
     }
 
@@ -112,15 +116,19 @@ void ColorUtils::applyTextColor(QWidget* widget, const QColor &color)
     }
 
     // Updates all table elements' colors
-    for (QTableWidget* table : widget->findChildren<QTableWidget*>()) {
+    for (QAbstractItemView* table : widget->findChildren<QAbstractItemView*>()) {
+        // Headers are styled through their view's QHeaderView::section rule
+        if (qobject_cast<QHeaderView*>(table)) {
+            continue;
+        }
         QString style = table->styleSheet();
 
-        // Only replace the color property within QTableWidget rule
-        if (style.contains(QRegularExpression("QTableWidget\\s*\\{[^}]*color:"))) {
-            style.replace(QRegularExpression("(QTableWidget\\s*\\{[^}]*)color:\\s*[^;]+(;[^}]*\\})"), QString("\\1color: %1\\2").arg(color.name()));
+        // Only replace the color property within QAbstractItemView rule
+        if (style.contains(QRegularExpression("QAbstractItemView\\s*\\{[^}]*color:"))) {
+            style.replace(QRegularExpression("(QAbstractItemView\\s*\\{[^}]*)color:\\s*[^;]+(;[^}]*\\})"), QString("\\1color: %1\\2").arg(color.name()));
         } else {
-            // Add color to existing QTableWidget rule or create new one
-            style.replace(QRegularExpression("(QTableWidget\\s*\\{)"), QString("\\1 color: %1;").arg(color.name()));
+            // Add color to existing QAbstractItemView rule or create new one
+            style.replace(QRegularExpression("(QAbstractItemView\\s*\\{)"), QString("\\1 color: %1;").arg(color.name()));
         }
 
         if (style.contains(QRegularExpression("QHeaderView::section\\s*\\{[^}]*color:"))) {
@@ -0,0 +1,142 @@
+#include "PressureStall.h"
+#include <QDebug>
+#include <QFile>
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+PressureStall::PressureStall(Resource resource, QObject *parent)
+    : QObject(parent)
+    , m_resource(resource)
+    , m_info()
+{
+    sample(SampleTick::now());
+}
+
+PressureStall::~PressureStall()
+{
+    for (const Trigger &trigger : m_triggers) {
+        delete trigger.notifier;
+        ::close(trigger.fd);
+    }
+}
+
+QString PressureStall::pressurePath() const
+{
+    switch (m_resource) {
+    case Cpu:
+        return "/proc/pressure/cpu";
+    case Memory:
+        return "/proc/pressure/memory";
+    case Io:
+        return "/proc/pressure/io";
+    }
+    return QString();
+}
+
+bool PressureStall::addTrigger(bool full, int stallUs, int windowUs)
+{
+    const QByteArray path = QFile::encodeName(pressurePath());
+    const int fd = ::open(path.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        qDebug() << "Cannot open" << pressurePath() << "for triggers:" << strerror(errno);
+        return false;
+    }
+
+    // The kernel expects the terminating NUL as part of the write
+    const QByteArray spec = QByteArray(full ? "full " : "some ") + QByteArray::number(stallUs) + ' '
+                            + QByteArray::number(windowUs);
+    if (::write(fd, spec.constData(), spec.size() + 1) < 0) {
+        qDebug() << "PSI trigger" << spec << "rejected:" << strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    // Trigger events are reported as POLLPRI, which QSocketNotifier exposes as Exception
+    Trigger trigger;
+    trigger.fd = fd;
+    trigger.full = full;
+    trigger.notifier = new QSocketNotifier(fd, QSocketNotifier::Exception, this);
+    const int index = m_triggers.size();
+    connect(trigger.notifier, &QSocketNotifier::activated, this, [this, index]() {
+        onTrigger(index);
+    });
+    m_triggers.append(trigger);
+    return true;
+}
+
+void PressureStall::onTrigger(int index)
+{
+    // Refresh right away so the page shows the averages that crossed the threshold
+    sample(SampleTick::now());
+    emit stallTriggered(m_triggers[index].full);
+}
+
+void PressureStall::sample(const SampleTick &tick)
+{
+    QFile file(pressurePath());
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_info.available = false;
+        return;
+    }
+
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    // full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    file.close();
+
+    m_info.hasFull = false;
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.split(' ');
+        if (fields.size() < 5) {
+            continue;
+        }
+
+        const bool full = fields[0] == "full";
+        m_info.hasFull = m_info.hasFull || full;
+        double *averages = full ? m_info.full : m_info.some;
+        quint64 &total = full ? m_info.fullTotal : m_info.someTotal;
+
+        for (int i = 1; i < fields.size(); ++i) {
+            const int eq = fields[i].indexOf('=');
+            if (eq < 0) {
+                continue;
+            }
+            const QByteArray key = fields[i].left(eq);
+            const QByteArray value = fields[i].mid(eq + 1);
+            if (key == "avg10") {
+                averages[0] = value.toDouble();
+            } else if (key == "avg60") {
+                averages[1] = value.toDouble();
+            } else if (key == "avg300") {
+                averages[2] = value.toDouble();
+            } else if (key == "total") {
+                total = value.toULongLong();
+            }
+        }
+    }
+
+    m_info.available = true;
+    m_info.tick = tick;
+    emit pressureUpdated(m_info);
+}
+
+QString PressureStall::getPressureString(const PressureInfo &info)
+{
+    if (!info.available) {
+        return QString("Pressure: N/A");
+    }
+
+    const QString full = info.hasFull ? QString("%1% / %2% / %3%")
+                                            .arg(info.full[0], 0, 'f', 2)
+                                            .arg(info.full[1], 0, 'f', 2)
+                                            .arg(info.full[2], 0, 'f', 2)
+                                      : QString("N/A");
+    return QString("Pressure some: %1% / %2% / %3%  full: %4")
+        .arg(info.some[0], 0, 'f', 2)
+        .arg(info.some[1], 0, 'f', 2)
+        .arg(info.some[2], 0, 'f', 2)
+        .arg(full);
+}
@@ -0,0 +1,63 @@
+#ifndef PRESSURESTALL_H
+#define PRESSURESTALL_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "SampleScheduler.h"
+
+class QSocketNotifier;
+
+// Share of wall time some/all tasks were stalled on one resource, from /proc/pressure
+struct PressureInfo
+{
+    bool available;   // false when the kernel has no PSI (CONFIG_PSI=n or psi=0)
+    double some[3];   // avg10, avg60, avg300 in percent
+    double full[3];   // avg10, avg60, avg300 in percent
+    bool hasFull;     // false where the file has no full line, e.g. cpu before Linux 5.13
+    quint64 someTotal; // cumulative stall time in microseconds
+    quint64 fullTotal;
+    SampleTick tick;  // sequence 0 when a trigger forced the read between ticks
+};
+
+class PressureStall : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Resource { Cpu, Memory, Io };
+
+    explicit PressureStall(Resource resource, QObject *parent = nullptr);
+    ~PressureStall();
+
+    static QString getPressureString(const PressureInfo &info);
+    PressureInfo getPressureInfo() const { return m_info; }
+
+    // Registers a kernel trigger: stallTriggered fires as soon as tasks were stalled for more
+    // than stallUs within any windowUs window. Unprivileged users need windowUs to be a
+    // multiple of 2 s.
+    bool addTrigger(bool full, int stallUs, int windowUs);
+
+    void sample(const SampleTick &tick);
+
+signals:
+    void pressureUpdated(const PressureInfo &info);
+    void stallTriggered(bool full);
+
+private:
+    struct Trigger
+    {
+        int fd;
+        bool full;
+        QSocketNotifier *notifier;
+    };
+
+    QString pressurePath() const;
+    void onTrigger(int index);
+
+    Resource m_resource;
+    PressureInfo m_info;
+    QVector<Trigger> m_triggers;
+};
+
+#endif // PRESSURESTALL_H
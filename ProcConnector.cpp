@@ -0,0 +1,124 @@
+#include "ProcConnector.h"
+#include <QDebug>
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstring>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+ProcConnector::ProcConnector(QObject *parent)
+    : QObject(parent)
+    , m_fd(-1)
+    , m_notifier(nullptr)
+{
+    const int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) {
+        return;
+    }
+
+    sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return;
+    }
+
+    // Bursts of fork/exit from parallel builds easily fill the default buffer
+    const int bufferSize = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    m_fd = fd;
+    if (!subscribe(true)) {
+        qDebug() << "Proc connector unavailable, falling back to /proc scans:" << strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        return;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &ProcConnector::readEvents);
+}
+
+ProcConnector::~ProcConnector()
+{
+    if (m_fd >= 0) {
+        delete m_notifier;
+        subscribe(false);
+        ::close(m_fd);
+    }
+}
+
+bool ProcConnector::subscribe(bool listen)
+{
+    alignas(nlmsghdr) char buffer[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))];
+    memset(buffer, 0, sizeof(buffer));
+
+    nlmsghdr *header = reinterpret_cast<nlmsghdr *>(buffer);
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    header->nlmsg_type = NLMSG_DONE;
+    header->nlmsg_pid = getpid();
+
+    cn_msg *message = static_cast<cn_msg *>(NLMSG_DATA(header));
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(proc_cn_mcast_op);
+    const proc_cn_mcast_op op = listen ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+    memcpy(message->data, &op, sizeof(op));
+
+    return send(m_fd, header, header->nlmsg_len, 0) == static_cast<ssize_t>(header->nlmsg_len);
+}
+
+void ProcConnector::readEvents()
+{
+    alignas(nlmsghdr) char buffer[8192];
+
+    for (;;) {
+        const ssize_t length = recv(m_fd, buffer, sizeof(buffer), 0);
+        if (length < 0) {
+            if (errno == ENOBUFS) {
+                emit eventsLost();
+                continue;
+            }
+            // EAGAIN, drained
+            return;
+        }
+
+        int remaining = static_cast<int>(length);
+        for (nlmsghdr *header = reinterpret_cast<nlmsghdr *>(buffer); NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) {
+                continue;
+            }
+
+            const cn_msg *message = static_cast<const cn_msg *>(NLMSG_DATA(header));
+            if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) {
+                continue;
+            }
+
+            const proc_event *event = reinterpret_cast<const proc_event *>(message->data);
+            switch (event->what) {
+            case proc_event::PROC_EVENT_FORK:
+                if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid) {
+                    emit processForked(event->event_data.fork.child_tgid, event->event_data.fork.parent_tgid);
+                }
+                break;
+            case proc_event::PROC_EVENT_EXEC:
+                emit processExeced(event->event_data.exec.process_tgid);
+                break;
+            case proc_event::PROC_EVENT_EXIT:
+                if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+                    emit processExited(event->event_data.exit.process_tgid,
+                                       static_cast<int>(event->event_data.exit.exit_code));
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
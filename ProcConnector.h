@@ -0,0 +1,36 @@
+#ifndef PROCCONNECTOR_H
+#define PROCCONNECTOR_H
+
+#include <QObject>
+
+class QSocketNotifier;
+
+// Process fork/exec/exit notifications from the kernel's netlink proc connector. Subscribing
+// needs CAP_NET_ADMIN, isListening() is false without it and callers should keep scanning /proc.
+// Thread-level events are filtered out, only whole processes (thread group leaders) are reported.
+class ProcConnector : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProcConnector(QObject *parent = nullptr);
+    ~ProcConnector();
+
+    bool isListening() const { return m_fd >= 0; }
+
+signals:
+    void processForked(int pid, int parentPid);
+    void processExeced(int pid);
+    void processExited(int pid, int exitCode);
+    // The socket buffer overran and events were dropped, the live set has to be rebuilt
+    void eventsLost();
+
+private:
+    bool subscribe(bool listen);
+    void readEvents();
+
+    int m_fd;
+    QSocketNotifier *m_notifier;
+};
+
+#endif // PROCCONNECTOR_H
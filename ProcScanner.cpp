@@ -0,0 +1,448 @@
+#include "ProcScanner.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+// Layout the getdents64 syscall fills in, glibc only exposes a wrapper since 2.30
+struct LinuxDirent64
+{
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+const unsigned long PF_KTHREAD = 0x00200000;
+
+// PIDs claimed per atomic increment, small enough to balance and large enough to keep the
+// cursor cache line quiet
+const std::size_t ChunkSize = 32;
+
+// "<pid>/<file>" without snprintf, returns false if it does not fit
+bool buildPath(char *path, std::size_t size, int pid, const char *file)
+{
+    char digits[12];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + pid % 10);
+        pid /= 10;
+    } while (pid > 0);
+
+    const std::size_t fileLength = strlen(file);
+    if (count + 1 + fileLength + 1 > size) {
+        return false;
+    }
+
+    char *out = path;
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
+    *out++ = '/';
+    memcpy(out, file, fileLength + 1);
+    return true;
+}
+
+// Reads a whole small /proc file into buffer, returns the byte count or -1
+ssize_t readFile(int dirFd, const char *path, char *buffer, std::size_t size)
+{
+    const int fd = openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    std::size_t total = 0;
+    while (total < size) {
+        const ssize_t n = ::read(fd, buffer + total, size - total);
+        if (n < 0) {
+            ::close(fd);
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    ::close(fd);
+    return static_cast<ssize_t>(total);
+}
+
+// Parses one unsigned decimal at pos and moves pos past it and the following space
+quint64 nextField(const char *&pos, const char *end)
+{
+    bool negative = false;
+    if (pos < end && *pos == '-') {
+        negative = true;
+        ++pos;
+    }
+    quint64 value = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+        value = value * 10 + (*pos - '0');
+        ++pos;
+    }
+    while (pos < end && *pos == ' ') {
+        ++pos;
+    }
+    return negative ? 0 : value;
+}
+
+void skipField(const char *&pos, const char *end)
+{
+    while (pos < end && *pos != ' ') {
+        ++pos;
+    }
+    while (pos < end && *pos == ' ') {
+        ++pos;
+    }
+}
+} // namespace
+
+ProcScanner::ProcScanner()
+    : m_procFd(open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+    , m_uptime(0.0)
+    , m_direntBuffer(64 * 1024)
+    , m_workers(0)
+{
+    setWorkerCount(1);
+}
+
+ProcScanner::~ProcScanner()
+{
+    if (m_procFd >= 0) {
+        ::close(m_procFd);
+    }
+}
+
+void ProcScanner::setWorkerCount(int workers)
+{
+    workers = qMax(1, workers);
+    if (workers == m_workers) {
+        return;
+    }
+
+    m_workers = workers;
+    m_shards.reset(new Shard[workers]);
+    m_slices.resize(workers);
+    // The calling thread is worker 0
+    m_pool.setMaxThreadCount(qMax(1, workers - 1));
+}
+
+const std::vector<int> &ProcScanner::listPids()
+{
+    m_pids.clear();
+    if (m_procFd >= 0) {
+        lseek(m_procFd, 0, SEEK_SET);
+        listNumericEntries(m_procFd, m_pids);
+    }
+    return m_pids;
+}
+
+bool ProcScanner::listTasks(int pid, std::vector<int> &tids)
+{
+    tids.clear();
+    char path[32];
+    if (!buildPath(path, sizeof(path), pid, "task")) {
+        return false;
+    }
+    const int fd = openat(m_procFd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    listNumericEntries(fd, tids);
+    ::close(fd);
+    return true;
+}
+
+bool ProcScanner::readTask(int pid, int tid, ProcSample &sample)
+{
+    // "<pid>/task/<tid>/stat"
+    char file[32] = "task/";
+    if (!buildPath(file + 5, sizeof(file) - 5, tid, "stat")) {
+        return false;
+    }
+    char path[48];
+    if (!buildPath(path, sizeof(path), pid, file)) {
+        return false;
+    }
+    const ssize_t n = readFile(m_procFd, path, m_buffer, sizeof(m_buffer));
+    if (n <= 0) {
+        return false;
+    }
+    sample.pid = tid;
+    sample.haveIo = false;
+    return parseStat(m_buffer, n, sample);
+}
+
+ssize_t ProcScanner::readPidFile(int pid, const char *file, char *buffer, std::size_t size)
+{
+    char path[48];
+    if (!buildPath(path, sizeof(path), pid, file)) {
+        return -1;
+    }
+    return readFile(m_procFd, path, buffer, size);
+}
+
+void ProcScanner::listNumericEntries(int dirFd, std::vector<int> &out)
+{
+    for (;;) {
+        const long n = syscall(SYS_getdents64, dirFd, m_direntBuffer.data(), m_direntBuffer.size());
+        if (n <= 0) {
+            break;
+        }
+        for (long offset = 0; offset < n;) {
+            const LinuxDirent64 *entry = reinterpret_cast<const LinuxDirent64 *>(m_direntBuffer.data() + offset);
+            offset += entry->d_reclen;
+
+            const char *name = entry->d_name;
+            if (*name < '1' || *name > '9') {
+                continue;
+            }
+            int id = 0;
+            for (; *name >= '0' && *name <= '9'; ++name) {
+                id = id * 10 + (*name - '0');
+            }
+            if (*name == '\0') {
+                out.push_back(id);
+            }
+        }
+    }
+}
+
+double ProcScanner::readUptime()
+{
+    char buffer[64];
+    const ssize_t n = readFile(m_procFd, "uptime", buffer, sizeof(buffer) - 1);
+    if (n > 0) {
+        buffer[n] = '\0';
+        m_uptime = strtod(buffer, nullptr);
+    }
+    return m_uptime;
+}
+
+const std::vector<ProcSample> &ProcScanner::scan(bool withIo)
+{
+    listPids();
+    return scanListed(withIo);
+}
+
+const std::vector<ProcSample> &ProcScanner::scanPids(const std::vector<int> &pids, bool withIo)
+{
+    m_pids.assign(pids.begin(), pids.end());
+    return scanListed(withIo);
+}
+
+bool ProcScanner::readOne(int pid, bool withIo, ProcSample &sample)
+{
+    return readProcess(m_procFd, pid, withIo, sample, m_buffer, sizeof(m_buffer));
+}
+
+const std::vector<ProcSample> &ProcScanner::scanListed(bool withIo)
+{
+    readUptime();
+
+    if (m_workers > 1 && m_pids.size() >= ParallelThreshold) {
+        scanParallel(withIo);
+        return m_samples;
+    }
+
+    m_samples.resize(m_pids.size());
+    std::size_t count = 0;
+    for (int pid : m_pids) {
+        if (readProcess(m_procFd, pid, withIo, m_samples[count], m_buffer, sizeof(m_buffer))) {
+            ++count;
+        }
+    }
+    m_samples.resize(count);
+    return m_samples;
+}
+
+void ProcScanner::scanParallel(bool withIo)
+{
+    const std::size_t count = m_pids.size();
+    const std::size_t perShard = (count + m_workers - 1) / m_workers;
+    for (int i = 0; i < m_workers; ++i) {
+        const std::size_t begin = qMin(count, i * perShard);
+        m_shards[i].next.store(begin, std::memory_order_relaxed);
+        m_shards[i].end = qMin(count, begin + perShard);
+    }
+
+    for (int worker = 1; worker < m_workers; ++worker) {
+        m_pool.start([this, worker, withIo]() { runWorker(worker, withIo); });
+    }
+    runWorker(0, withIo);
+    m_pool.waitForDone();
+
+    // Every slice is owned by exactly one worker, so the merge needs no locking, only the
+    // happens-before from waitForDone()
+    std::size_t total = 0;
+    for (const std::vector<ProcSample> &slice : m_slices) {
+        total += slice.size();
+    }
+    m_samples.resize(total);
+    ProcSample *out = m_samples.data();
+    for (const std::vector<ProcSample> &slice : m_slices) {
+        out = std::copy(slice.begin(), slice.end(), out);
+    }
+}
+
+void ProcScanner::runWorker(int worker, bool withIo)
+{
+    char buffer[BufferSize];
+    std::vector<ProcSample> &slice = m_slices[worker];
+    slice.clear();
+
+    // Own shard first, then steal from the others in order
+    for (int i = 0; i < m_workers; ++i) {
+        Shard &shard = m_shards[(worker + i) % m_workers];
+        for (;;) {
+            const std::size_t begin = shard.next.fetch_add(ChunkSize, std::memory_order_relaxed);
+            if (begin >= shard.end) {
+                break;
+            }
+            const std::size_t end = qMin(begin + ChunkSize, shard.end);
+            for (std::size_t k = begin; k < end; ++k) {
+                slice.emplace_back();
+                if (!readProcess(m_procFd, m_pids[k], withIo, slice.back(), buffer, sizeof(buffer))) {
+                    slice.pop_back();
+                }
+            }
+        }
+    }
+}
+
+bool ProcScanner::readProcess(int procFd, int pid, bool withIo, ProcSample &sample, char *buffer, std::size_t size)
+{
+    char path[32];
+    if (!buildPath(path, sizeof(path), pid, "stat")) {
+        return false;
+    }
+    const ssize_t n = readFile(procFd, path, buffer, size);
+    if (n <= 0) {
+        return false;
+    }
+
+    sample.pid = pid;
+    if (!parseStat(buffer, n, sample)) {
+        return false;
+    }
+
+    sample.haveIo = false;
+    sample.readBytes = 0;
+    sample.writeBytes = 0;
+    sample.cancelledWriteBytes = 0;
+    sample.syscr = 0;
+    sample.syscw = 0;
+    if (withIo && !sample.kernelThread) {
+        readIoFile(procFd, sample, buffer, size);
+    }
+    return true;
+}
+
+void ProcScanner::readIoFile(int procFd, ProcSample &sample, char *buffer, std::size_t size)
+{
+    char path[32];
+    if (!buildPath(path, sizeof(path), sample.pid, "io")) {
+        return;
+    }
+    const ssize_t length = readFile(procFd, path, buffer, size);
+    if (length > 0) {
+        parseIo(buffer, length, sample);
+    }
+}
+
+bool ProcScanner::readIo(ProcSample &sample)
+{
+    readIoFile(m_procFd, sample, m_buffer, sizeof(m_buffer));
+    return sample.haveIo;
+}
+
+bool ProcScanner::parseStat(const char *data, std::size_t length, ProcSample &sample)
+{
+    // pid (comm) state ppid ... the comm may itself contain spaces and parentheses
+    const char *open = static_cast<const char *>(memchr(data, '(', length));
+    const char *close = static_cast<const char *>(memrchr(data, ')', length));
+    if (!open || !close || close < open) {
+        return false;
+    }
+
+    std::size_t commLength = qMin<std::size_t>(close - open - 1, sizeof(sample.comm) - 1);
+    memcpy(sample.comm, open + 1, commLength);
+    sample.comm[commLength] = '\0';
+
+    const char *end = data + length;
+    const char *pos = close + 1;
+    while (pos < end && *pos == ' ') {
+        ++pos;
+    }
+    if (pos >= end) {
+        return false;
+    }
+
+    // Field 3 onwards, numbered as in proc(5)
+    sample.state = *pos;
+    skipField(pos, end);
+    sample.ppid = static_cast<int>(nextField(pos, end)); // 4
+    for (int field = 5; field < 9; ++field) {
+        skipField(pos, end);
+    }
+    sample.kernelThread = (nextField(pos, end) & PF_KTHREAD) != 0; // 9
+    for (int field = 10; field < 14; ++field) {
+        skipField(pos, end);
+    }
+    sample.utime = nextField(pos, end); // 14
+    sample.stime = nextField(pos, end); // 15
+    for (int field = 16; field < 20; ++field) {
+        skipField(pos, end);
+    }
+    sample.numThreads = static_cast<int>(nextField(pos, end)); // 20
+    skipField(pos, end);
+    sample.starttime = nextField(pos, end); // 22
+    skipField(pos, end);
+    sample.rssPages = static_cast<long>(nextField(pos, end)); // 24
+    for (int field = 25; field < 39; ++field) {
+        skipField(pos, end);
+    }
+    sample.processor = static_cast<int>(nextField(pos, end)); // 39
+    skipField(pos, end);
+    skipField(pos, end);
+    sample.blkioTicks = nextField(pos, end); // 42, 0 on kernels older than 2.6.18
+    return pos <= end;
+}
+
+void ProcScanner::parseIo(const char *data, std::size_t length, ProcSample &sample)
+{
+    // rchar, wchar, syscr, syscw, read_bytes, write_bytes, cancelled_write_bytes, one pass
+    const char *end = data + length;
+    for (const char *line = data; line < end;) {
+        const char *colon = static_cast<const char *>(memchr(line, ':', end - line));
+        if (!colon) {
+            break;
+        }
+        const std::size_t keyLength = colon - line;
+        const char *pos = colon + 1;
+        while (pos < end && *pos == ' ') {
+            ++pos;
+        }
+        const quint64 value = nextField(pos, end);
+
+        if (keyLength == 5 && memcmp(line, "syscr", 5) == 0) {
+            sample.syscr = value;
+        } else if (keyLength == 5 && memcmp(line, "syscw", 5) == 0) {
+            sample.syscw = value;
+        } else if (keyLength == 10 && memcmp(line, "read_bytes", 10) == 0) {
+            sample.readBytes = value;
+        } else if (keyLength == 11 && memcmp(line, "write_bytes", 11) == 0) {
+            sample.writeBytes = value;
+        } else if (keyLength == 21 && memcmp(line, "cancelled_write_bytes", 21) == 0) {
+            sample.cancelledWriteBytes = value;
+        }
+
+        const char *next = static_cast<const char *>(memchr(pos, '\n', end - pos));
+        line = next ? next + 1 : end;
+    }
+    sample.haveIo = true;
+}
@@ -0,0 +1,119 @@
+#ifndef PROCSCANNER_H
+#define PROCSCANNER_H
+
+#include <QThreadPool>
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <sys/types.h>
+#include <vector>
+
+// Raw counters for one PID from a single /proc pass, rates are computed by ProcessInfo
+struct ProcSample
+{
+    int pid;
+    int ppid;
+    char state;          // R, S, D, Z, ...
+    bool kernelThread;   // PF_KTHREAD in the stat flags
+    char comm[16];       // NUL terminated, the kernel caps it at 15 characters
+    quint64 utime;       // clock ticks
+    quint64 stime;
+    quint64 starttime;   // clock ticks after boot
+    int numThreads;
+    long rssPages;
+    int processor;       // CPU it last ran on
+    quint64 blkioTicks;  // delayacct_blkio_ticks, time spent waiting for block I/O
+    bool haveIo;         // io is only readable for our own processes unless privileged
+    quint64 readBytes;   // storage layer bytes
+    quint64 writeBytes;
+    quint64 cancelledWriteBytes; // written to page cache but truncated before writeback
+    quint64 syscr;       // read and write syscalls
+    quint64 syscw;
+};
+
+// Walks /proc with getdents64 on a directory fd it keeps open and reads every file with openat
+// into fixed buffers, so a steady-state scan does no heap allocation. Parsing lives in static
+// functions that only touch their arguments and can run on several threads at once, which the
+// parallel mode uses to shard large PID lists across a small pool.
+class ProcScanner
+{
+public:
+    static const std::size_t BufferSize = 4096;
+    // Below this many PIDs waking the pool costs more than it saves
+    static const std::size_t ParallelThreshold = 2048;
+
+    ProcScanner();
+    ~ProcScanner();
+
+    ProcScanner(const ProcScanner &) = delete;
+    ProcScanner &operator=(const ProcScanner &) = delete;
+
+    bool isOpen() const { return m_procFd >= 0; }
+
+    // 1 scans on the calling thread only, more splits large scans across that many threads
+    void setWorkerCount(int workers);
+    int workerCount() const { return m_workers; }
+    int procFd() const { return m_procFd; }
+
+    // Numeric entries of /proc in directory order, the vector is reused between calls
+    const std::vector<int> &listPids();
+    const std::vector<int> &pids() const { return m_pids; }
+
+    // Seconds since boot from /proc/uptime
+    double readUptime();
+    double uptime() const { return m_uptime; }
+
+    // listPids, readUptime and readProcess for every PID. Processes that exit mid-scan are
+    // dropped, so samples() can be shorter than pids().
+    const std::vector<ProcSample> &scan(bool withIo);
+    const std::vector<ProcSample> &samples() const { return m_samples; }
+
+    // Same as scan() for a PID list kept elsewhere, e.g. one maintained from proc connector events
+    const std::vector<ProcSample> &scanPids(const std::vector<int> &pids, bool withIo);
+    // Reads a single PID on the calling thread without touching samples()
+    bool readOne(int pid, bool withIo, ProcSample &sample);
+
+    // Thread ids of one process and their task stat, for drill-down into a single PID
+    bool listTasks(int pid, std::vector<int> &tids);
+    bool readTask(int pid, int tid, ProcSample &sample);
+
+    // Any other small file of one PID, e.g. "cgroup". Returns the byte count or -1.
+    ssize_t readPidFile(int pid, const char *file, char *buffer, std::size_t size);
+
+    // io for one PID that was scanned without it, e.g. the winners of a top-N pass
+    bool readIo(ProcSample &sample);
+
+    static bool readProcess(int procFd, int pid, bool withIo, ProcSample &sample, char *buffer, std::size_t size);
+    static void readIoFile(int procFd, ProcSample &sample, char *buffer, std::size_t size);
+    static bool parseStat(const char *data, std::size_t length, ProcSample &sample);
+    static void parseIo(const char *data, std::size_t length, ProcSample &sample);
+
+private:
+    // One contiguous range of m_pids, workers claim chunks of it through the atomic cursor and
+    // move on to the other shards once their own runs dry
+    struct alignas(64) Shard
+    {
+        std::atomic<std::size_t> next;
+        std::size_t end;
+    };
+
+    const std::vector<ProcSample> &scanListed(bool withIo);
+    void listNumericEntries(int dirFd, std::vector<int> &out);
+    void scanParallel(bool withIo);
+    void runWorker(int worker, bool withIo);
+
+    int m_procFd;
+    double m_uptime;
+    std::vector<char> m_direntBuffer;
+    std::vector<int> m_pids;
+    std::vector<ProcSample> m_samples;
+    char m_buffer[BufferSize];
+
+    int m_workers;
+    std::unique_ptr<Shard[]> m_shards;
+    std::vector<std::vector<ProcSample>> m_slices; // one per worker, merged into m_samples
+    QThreadPool m_pool;
+};
+
+#endif // PROCSCANNER_H
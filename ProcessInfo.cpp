@@ -1,290 +1,470 @@
 #include "ProcessInfo.h"
-#include <QFile>
-#include <QDir>
-#include <sys/sysinfo.h>
-#include <QRegularExpression>
 #include <QDebug>
-#include <vector>
-#include <QDirIterator>
+#include <QFile>
+#include <QMetaMethod>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
 #include <unistd.h>
 
 
 ProcessInfo::ProcessInfo(QObject *parent)
     :QObject(parent)
+    , m_listChanged(true)
+    , m_generation(0)
+    , m_lastUptime(0.0)
+    , m_clockTicks(sysconf(_SC_CLK_TCK))
+    , m_pageSizeMB(sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0))
+    , m_pidCount(0)
+    , m_skippedCount(0)
+    , m_threadCount(0)
+    , m_topN(0)
+    , m_sortKey(ByCpu)
+    , m_delayAcct(false)
+    , m_connector(nullptr)
+    , m_needReconcile(true)
+    , m_ticksSinceReconcile(0)
+    , m_watchedPid(0)
+    , m_watchedStartTime(0)
+    , m_threadUptime(0.0)
+
+{
+    m_exitLog.reset(ExitLogSize);
+
+    if (!m_scanner.isOpen()) {
+        qWarning() << "Cannot open /proc";
+    }
+
+    // Optional, needs CAP_NET_ADMIN; SYSMON_PROC_CONNECTOR=0 forces plain scanning
+    if (qEnvironmentVariable("SYSMON_PROC_CONNECTOR") != "0") {
+        m_connector = new ProcConnector(this);
+        if (m_connector->isListening()) {
+            connect(m_connector, &ProcConnector::processForked, this, &ProcessInfo::onProcessForked);
+            connect(m_connector, &ProcConnector::processExeced, this, &ProcessInfo::onProcessExeced);
+            connect(m_connector, &ProcConnector::processExited, this, &ProcessInfo::onProcessExited);
+            connect(m_connector, &ProcConnector::eventsLost, this, [this]() { m_needReconcile = true; });
+        } else {
+            delete m_connector;
+            m_connector = nullptr;
+        }
+    }
 
+    // Scaling flattens out past 8 threads as the kernel's own /proc locking takes over
+    bool ok = false;
+    const int workers = qEnvironmentVariableIntValue("SYSMON_SCAN_WORKERS", &ok);
+    setScanWorkers(ok ? workers : qMin(QThread::idealThreadCount(), 8));
+
+    sample(SampleTick::now());
+}
+
+void ProcessInfo::setScanWorkers(int workers)
 {
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this,&ProcessInfo::updateProcessInfo);
-    m_timer->start(1000);
-    updateProcessInfo();
+    m_scanner.setWorkerCount(workers);
 }
 
-bool ProcessInfo::containsLetters(const QString &word)
+void ProcessInfo::setTopN(int count, ProcessInfo::SortKey key)
 {
-    for(QChar c : word)
+    m_topN = qMax(0, count);
+    m_sortKey = key;
+    if (key == ByIo)
     {
-        if(c.isLetter())
-        {
-            return true;
-        }
+        QFile delayAcct("/proc/sys/kernel/task_delayacct");
+        m_delayAcct = delayAcct.open(QIODevice::ReadOnly) && delayAcct.readAll().trimmed() == "1";
     }
-    return false;
 }
 
-std::vector<QDir> ProcessInfo::getProcesses()
+void ProcessInfo::setWatchedPid(int pid)
 {
-    std::vector<QDir> processes;
-    QDirIterator it("/proc", QDir::Dirs | QDir::NoDotAndDotDot);
+    if (pid == m_watchedPid)
+    {
+        return;
+    }
+    m_watchedPid = qMax(0, pid);
+    m_watchedStartTime = 0;
+    m_threadTicks.clear();
+    m_threadUptime = 0.0;
+    if (m_watchedPid > 0)
+    {
+        m_scanner.readUptime();
+        sampleThreads(SampleTick::now());
+    }
+}
 
-    while(it.hasNext())
+void ProcessInfo::sampleThreads(const SampleTick &tick)
+{
+    QVector<ThreadUsage> threads;
+    ProcSample leader;
+    // A different start time means the PID was reused, the watched process is gone
+    const bool alive = m_scanner.readOne(m_watchedPid, false, leader)
+                       && (m_watchedStartTime == 0 || leader.starttime == m_watchedStartTime)
+                       && m_scanner.listTasks(m_watchedPid, m_tids);
+    if (!alive)
     {
-        QString dirPath = it.next();
-        QString dirName = QFileInfo(dirPath).fileName();
+        m_threadTicks.clear();
+        emit threadsUpdated(m_watchedPid, threads, tick);
+        return;
+    }
+    m_watchedStartTime = leader.starttime;
 
-        if(containsLetters(dirName))
+    const double uptime = m_scanner.uptime();
+    const double elapsed = uptime - m_threadUptime;
+    const bool haveBaseline = m_threadUptime > 0.0 && elapsed > 0.0;
+    QHash<int, quint64> ticks;
+    ticks.reserve(static_cast<int>(m_tids.size()));
+    threads.reserve(static_cast<int>(m_tids.size()));
+
+    ProcSample task;
+    for (int tid : m_tids)
+    {
+        // Threads can exit between the listing and the read
+        if (!m_scanner.readTask(m_watchedPid, tid, task))
         {
             continue;
         }
+        const quint64 cpuTicks = task.utime + task.stime;
+        const auto previous = m_threadTicks.constFind(tid);
+
+        ThreadUsage thread;
+        thread.tid = tid;
+        thread.name = QString::fromUtf8(task.comm);
+        thread.state = task.state;
+        thread.lastCpu = task.processor;
+        thread.cpuUsage = (haveBaseline && previous != m_threadTicks.cend() && cpuTicks >= previous.value())
+                              ? ((cpuTicks - previous.value()) / m_clockTicks) / elapsed * 100
+                              : 0.0;
+        threads.append(thread);
+        ticks.insert(tid, cpuTicks);
+    }
+    m_threadTicks.swap(ticks);
+    m_threadUptime = uptime;
 
-        //checking if process is kernel process or zombie
-        QDir procDir(dirPath);
-        QFile cmdFile(procDir.filePath("cmdline"));
+    emit threadsUpdated(m_watchedPid, threads, tick);
+}
 
-        if(!cmdFile.open(QIODevice::ReadOnly | QIODevice::Text))
+void ProcessInfo::mergeSamples(const std::vector<ProcSample> &samples,
+                               std::vector<ProcessUsage> &processes)
+{
+    const double uptime = m_scanner.uptime();
+    const double elapsed = uptime - m_lastUptime;
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    const bool haveBaseline = m_generation > 0 && elapsed > 0.0;
+    ++m_generation;
+
+    m_pidCount = static_cast<int>(samples.size());
+    m_skippedCount = 0;
+    m_threadCount = 0;
+    processes.reserve(samples.size());
+    m_rankKeys.clear();
+    m_sampleIndex.clear();
+
+    for (int index = 0; index < static_cast<int>(samples.size()); ++index)
+    {
+        const ProcSample &sample = samples[index];
+        //kernel threads and zombies are single task entries
+        if (sample.kernelThread || sample.state == 'Z')
         {
+            m_skippedCount++;
+            m_threadCount++;
             continue;
         }
 
-        QString cmd = cmdFile.readAll().trimmed();
-        if(cmd.isEmpty())
+        const quint64 cpuTicks = sample.utime + sample.stime;
+        const ProcessKey key{sample.pid, sample.starttime};
+        auto it = previousCPUData.find(key);
+        const bool known = it != previousCPUData.end();
+        if (!known)
         {
-            continue;
+            it = previousCPUData.insert(key, ProcessCPUData());
+            // Everything is new on the first scan, that is not a spawn
+            if (m_generation > 1)
+            {
+                m_spawned.append(sample.pid);
+            }
         }
+        ProcessCPUData &data = it.value();
+
+        ProcessUsage proc;
+        proc.PID = sample.pid;
+        proc.ppid = sample.ppid;
+        proc.threads = sample.numThreads;
+        //usage = sum of utime and stime / elapsed time, 0 the first time a PID is seen
+        proc.cpuUsage = (known && haveBaseline && cpuTicks >= data.cpuTicks)
+                            ? ((cpuTicks - data.cpuTicks) / m_clockTicks) / (elapsed * processors) * 100
+                            : 0.0;
+        proc.ramUsage = sample.rssPages * m_pageSizeMB;
+        proc.startTime = sample.starttime;
+        updateIoRates(proc, data, sample, uptime);
+
+        if (!known || strcmp(data.comm, sample.comm) != 0)
+        {
+            m_listChanged = true;
+            memcpy(data.comm, sample.comm, sizeof(data.comm));
+            data.name = QString::fromUtf8(sample.comm);
+        }
+        proc.name = data.name;
 
-        processes.push_back(QDir(it.filePath()));
-    }
-
-    return processes;
-}
+        double rank = proc.cpuUsage;
+        if (m_sortKey == ByRam)
+        {
+            rank = proc.ramUsage;
+        }
+        else if (m_sortKey == ByIo)
+        {
+            rank = !m_delayAcct ? proc.readRate + proc.writeRate
+                   : (known && sample.blkioTicks >= data.blkioTicks) ? sample.blkioTicks - data.blkioTicks
+                                                                     : 0.0;
+        }
+        m_rankKeys.push_back(rank);
+        m_sampleIndex.push_back(index);
 
-QString ProcessInfo::getProcessName(int pid)
-{
-    QString commPath = QString("/proc/%1/comm").arg(pid);
-    QFile file(commPath);
+        data.cpuTicks = cpuTicks;
+        data.blkioTicks = sample.blkioTicks;
+        data.generation = m_generation;
 
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QString name = file.readLine().trimmed();
-        file.close();
-        return name;
+        m_threadCount += sample.numThreads;
+        processes.push_back(proc);
     }
 
-    return "Unknown";
+    m_lastUptime = uptime;
 }
 
-double ProcessInfo::getCPUUsage(int pid)
+void ProcessInfo::onProcessForked(int pid)
 {
+    m_livePids.insert(pid);
+}
 
-    const double SYSTEM_CLOCK_TICKS = sysconf(_SC_CLK_TCK);
-    const int SYSTEM_PROCESSORS =  sysconf(_SC_NPROCESSORS_ONLN);
-
-    static const QRegularExpression whitespaceRegex("\\s+");
-
-    QString uptimePath = QString("/proc/uptime");
-    QFile uptimeFile(uptimePath);
-
-
-    if(!uptimeFile.open(QIODevice::ReadOnly | QIODevice::Text))
+void ProcessInfo::onProcessExeced(int pid)
+{
+    // The new comm, in case the process is gone before the next tick
+    ProcSample sample;
+    if (m_scanner.readOne(pid, false, sample))
     {
-        return 0.0;
+        m_eventSamples.insert(pid, sample);
     }
+}
 
-    QTextStream in(&uptimeFile);
-    QStringList values = in.readLine().split(whitespaceRegex, Qt::SkipEmptyParts);
-    uptimeFile.close();
-    //usage = sum of utime and stime / elapsed time
-    //calculating elapsed time
-    double currentUptime = values[0].toDouble();
-
-    //getting from /proc/<PID>/stat
-    QString statPath = QString("/proc/%1/stat").arg(pid);
-    QFile statFile(statPath);
-
-    if(!statFile.open(QIODevice::ReadOnly | QIODevice::Text))
+void ProcessInfo::onProcessExited(int pid)
+{
+    // Usually still readable as a zombie until the parent reaps it
+    ProcSample sample;
+    if (m_scanner.readOne(pid, true, sample))
     {
-        return 0.0;
+        m_eventSamples.insert(pid, sample);
     }
+    m_livePids.remove(pid);
+    m_exitedPids.append(pid);
+}
 
-    QTextStream in1(&statFile);
-    QStringList cpuValues = in1.readLine().split(whitespaceRegex, Qt::SkipEmptyParts);
-    statFile.close();
-
-    if (cpuValues.size() < 22)
+void ProcessInfo::updateIoRates(ProcessUsage &proc,
+                                ProcessCPUData &data,
+                                const ProcSample &sample,
+                                double uptime)
+{
+    proc.bytesRead = static_cast<long>(sample.readBytes);
+    proc.bytesWritten = static_cast<long>(sample.writeBytes);
+    proc.readRate = proc.writeRate = 0.0;
+    proc.syscrRate = proc.syscwRate = proc.cancelledWriteRate = 0.0;
+    if (!sample.haveIo)
     {
-        return 0.0;
+        // Keep the last known totals for the exit log
+        proc.bytesRead = data.bytesRead;
+        proc.bytesWritten = data.bytesWritten;
+        return;
     }
 
-    double utime = cpuValues[13].toLong() / SYSTEM_CLOCK_TICKS;
-    double stime = cpuValues[14].toLong() / SYSTEM_CLOCK_TICKS;
-
-    if(!previousCPUData.contains(pid))
+    // Top-N mode reads io only while a process is among the winners, so the interval is per
+    // process rather than the tick length
+    const double elapsed = uptime - data.ioUptime;
+    if (data.ioUptime > 0.0 && elapsed > 0.0)
     {
-        ProcessCPUData data;
-        data.utime = utime;
-        data.stime = stime;
-        data.uptime = currentUptime;
-        previousCPUData[pid] = data;
-        return 0.0;
+        auto rate = [elapsed](quint64 now, quint64 before) {
+            return now >= before ? (now - before) / elapsed : 0.0;
+        };
+        proc.readRate = rate(sample.readBytes, data.bytesRead);
+        proc.writeRate = rate(sample.writeBytes, data.bytesWritten);
+        proc.syscrRate = rate(sample.syscr, data.syscr);
+        proc.syscwRate = rate(sample.syscw, data.syscw);
+        proc.cancelledWriteRate = rate(sample.cancelledWriteBytes, data.cancelledWriteBytes);
     }
-    ProcessCPUData prevData = previousCPUData[pid];
-    double timeDelta = currentUptime - prevData.uptime;
-    double cpuTimeDelta = (stime + utime) - (prevData.utime + prevData.stime);
-    double cpuUsage = (cpuTimeDelta / (timeDelta * SYSTEM_PROCESSORS))* 100;
 
-    ProcessCPUData newData;
-    newData.utime = utime;
-    newData.stime = stime;
-    newData.uptime = currentUptime;
-    previousCPUData[pid] = newData;
-
-    return cpuUsage;
+    data.bytesRead = proc.bytesRead;
+    data.bytesWritten = proc.bytesWritten;
+    data.syscr = sample.syscr;
+    data.syscw = sample.syscw;
+    data.cancelledWriteBytes = sample.cancelledWriteBytes;
+    data.ioUptime = uptime;
+}
 
+ExitedProcess ProcessInfo::exitFromSample(const ProcSample &sample, double uptime, qint64 timestamp) const
+{
+    ExitedProcess exited;
+    exited.PID = sample.pid;
+    exited.startTime = sample.starttime;
+    exited.name = QString::fromUtf8(sample.comm);
+    exited.cpuSeconds = (sample.utime + sample.stime) / m_clockTicks;
+    exited.bytesRead = static_cast<long>(sample.readBytes);
+    exited.bytesWritten = static_cast<long>(sample.writeBytes);
+    exited.lifetime = qMax(0.0, uptime - sample.starttime / m_clockTicks);
+    exited.exitTime = timestamp;
+    return exited;
 }
 
-double ProcessInfo::getRAMUsage(int pid)
+void ProcessInfo::collectExits(double uptime, qint64 timestamp)
 {
-    QString statusPath = QString("/proc/%1/status").arg(pid);
-    QFile statusFile(statusPath);
-    static const QRegularExpression whitespaceRegex("\\s+");
-    if(!statusFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    // Anything not seen in this scan has exited, a reused PID shows up here under its old starttime
+    for (auto it = previousCPUData.begin(); it != previousCPUData.end();)
     {
-        return 0.0;
-    }
+        const ProcessCPUData &data = it.value();
+        if (data.generation == m_generation)
+        {
+            ++it;
+            continue;
+        }
 
-    QTextStream in(&statusFile);
-    QString allContent = in.readAll();
-    statusFile.close();
+        ExitedProcess exited;
+        exited.PID = it.key().pid;
+        exited.startTime = it.key().startTime;
+        exited.name = data.name;
+        exited.cpuSeconds = data.cpuTicks / m_clockTicks;
+        exited.bytesRead = data.bytesRead;
+        exited.bytesWritten = data.bytesWritten;
+        exited.lifetime = qMax(0.0, uptime - it.key().startTime / m_clockTicks);
+        exited.exitTime = timestamp;
+
+        // A read taken when the exit event arrived has totals newer than the last tick
+        const auto event = m_eventSamples.find(exited.PID);
+        if (event != m_eventSamples.end() && event->starttime == it.key().startTime)
+        {
+            exited.cpuSeconds = (event->utime + event->stime) / m_clockTicks;
+            if (event->haveIo)
+            {
+                exited.bytesRead = static_cast<long>(event->readBytes);
+                exited.bytesWritten = static_cast<long>(event->writeBytes);
+            }
+            m_eventSamples.erase(event);
+        }
 
+        m_exited.append(exited);
+        m_exitLog.push(exited);
 
-    QStringList lines = allContent.split("\n");
+        it = previousCPUData.erase(it);
+        m_listChanged = true;
+    }
 
-    for(const QString &line : lines)
+    // Processes that started and exited between two ticks were never scanned, only the events saw them
+    for (int pid : m_exitedPids)
     {
-        if(line.startsWith("VmRSS:"))
+        const auto event = m_eventSamples.constFind(pid);
+        if (event == m_eventSamples.constEnd() || event->kernelThread
+            || previousCPUData.contains(ProcessKey{pid, event->starttime}))
         {
-
-            QStringList parts = line.split(whitespaceRegex, Qt::SkipEmptyParts);
-            if(parts.size() >= 2)
-            {
-                double vmRSS = parts[1].toDouble() / (1024);
-                return vmRSS;
-            }
+            continue;
         }
-    }
 
-    return 0.0;
+        const ExitedProcess exited = exitFromSample(*event, uptime, timestamp);
+        m_spawned.append(pid);
+        m_exited.append(exited);
+        m_exitLog.push(exited);
+    }
+    m_exitedPids.clear();
+    m_eventSamples.clear();
 }
 
-
-std::pair<long,long> ProcessInfo::getDiskInfo(int pid)
+void ProcessInfo::sample(const SampleTick &tick)
 {
-    long bytesRead = 0;
-    long bytesWritten = 0;
-
-    QString ioPath = QString(("/proc/%1/io")).arg(pid);
-    QFile ioFile(ioPath);
-    static const QRegularExpression whitespaceRegex("\\s+");
-
-    if(!ioFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    // Parsing and the rate merge are separate passes, the scan only produces raw counters.
+    // Top-N mode scans stat alone and reads io for the winners afterwards, unless it ranks by
+    // io bytes because blkio delay accounting is off.
+    const bool withIo = m_topN == 0 || (m_sortKey == ByIo && !m_delayAcct);
+    const bool reconcile = !m_connector || m_needReconcile || ++m_ticksSinceReconcile >= ReconcileTicks;
+    if (!reconcile)
     {
-        return std::make_pair(0, 0);
+        m_livePidList.assign(m_livePids.cbegin(), m_livePids.cend());
     }
+    const std::vector<ProcSample> &samples = reconcile ? m_scanner.scan(withIo)
+                                                       : m_scanner.scanPids(m_livePidList, withIo);
 
-    QTextStream in(&ioFile);
-    QString allContent = in.readAll();
-    ioFile.close();
-
-    QStringList lines = allContent.split("\n");
-    for(const QString &line: lines)
+    // Whatever could be read is the live set until the next events arrive
+    if (m_connector)
     {
-        if(line.startsWith("read_bytes:"))
+        m_livePids.clear();
+        m_livePids.reserve(static_cast<int>(samples.size()));
+        for (const ProcSample &sample : samples)
         {
-            QStringList parts = line.split(whitespaceRegex, Qt::SkipEmptyParts);
-            if(parts.size() >= 2)
-            {
-                bytesRead = parts[1].toLong();
-            }
+            m_livePids.insert(sample.pid);
         }
-
-        if(line.startsWith("write_bytes:"))
+        if (reconcile)
         {
-            QStringList parts = line.split(whitespaceRegex, Qt::SkipEmptyParts);
-            if(parts.size() >= 2)
-            {
-                bytesWritten = parts[1].toLong();
-            }
+            m_needReconcile = false;
+            m_ticksSinceReconcile = 0;
         }
     }
-    return std::make_pair(bytesRead, bytesWritten);
-}
 
-// for now iterate through the vector, collect pid, assign it to struct val, everything else
-// to 0, work to display on screen. If working, rinse and repeat
-
-void ProcessInfo::cleanupDeadProcesses(const std::vector<int>& currentPIDs)
-{
-    QSet<int> current(currentPIDs.begin(), currentPIDs.end());
+    std::vector<ProcessUsage> processes;
+    m_spawned.clear();
+    m_exited.clear();
+    mergeSamples(samples, processes);
+    if (m_topN > 0)
+    {
+        selectTop(samples, processes);
+    }
+    collectExits(m_scanner.uptime(), tick.timestamp);
+    if (m_watchedPid > 0)
+    {
+        sampleThreads(tick);
+    }
 
-    auto it = previousCPUData.begin();
-    int removed = 0;
+    emit processesUpdated(processes, tick);
+    emit totalsUpdated(m_pidCount, m_threadCount);
 
-    while(it != previousCPUData.end())
+    if (!m_spawned.isEmpty())
     {
-        if(!current.contains(it.key()))
-        {
-            it = previousCPUData.erase(it);
-            removed++;
-        }
-        else
+        emit processesSpawned(m_spawned, tick);
+    }
+    if (!m_exited.isEmpty())
+    {
+        emit processesExited(m_exited, tick);
+        emit exitLogUpdated(m_exitLog.toVector());
+    }
+    if (m_listChanged && isSignalConnected(QMetaMethod::fromSignal(&ProcessInfo::processListChanged)))
+    {
+        QVector<ProcessIdentity> list;
+        list.reserve(previousCPUData.size());
+        for (auto it = previousCPUData.cbegin(); it != previousCPUData.cend(); ++it)
         {
-            ++it;
+            list.append(ProcessIdentity{it.key().pid, it.key().startTime, it->name});
         }
+        m_listChanged = false;
+        emit processListChanged(list);
     }
-
 }
 
-void ProcessInfo::updateProcessInfo()
+void ProcessInfo::selectTop(const std::vector<ProcSample> &samples, std::vector<ProcessUsage> &processes)
 {
-    std::vector<ProcessUsage> processes;
-    std::vector<QDir> processDirs = getProcesses();
-    std::vector<int> currentPIDs;
-
-    for(const QDir &dir : processDirs)
+    m_order.resize(processes.size());
+    for (int i = 0; i < static_cast<int>(m_order.size()); ++i)
     {
-        QString dirName = dir.dirName();
-        bool ok;
-        int pid = dirName.toInt(&ok);
+        m_order[i] = i;
+    }
+
+    // Partial selection, the winners come out unordered, the view sorts them
+    const int count = qMin(m_topN, static_cast<int>(m_order.size()));
+    std::nth_element(m_order.begin(), m_order.begin() + count, m_order.end(), [this](int a, int b) {
+        return m_rankKeys[a] > m_rankKeys[b];
+    });
 
-        if(ok)
+    std::vector<ProcessUsage> winners;
+    winners.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        ProcessUsage proc = processes[m_order[i]];
+        ProcSample sample = samples[m_sampleIndex[m_order[i]]];
+        if (!sample.haveIo && m_scanner.readIo(sample))
         {
-            currentPIDs.push_back(pid);
-
-            ProcessUsage proc;
-            proc.PID = pid;
-            proc.name = getProcessName(pid);
-            proc.cpuUsage = getCPUUsage(pid);
-            proc.ramUsage = getRAMUsage(pid);
-            std::pair<long, long> diskInfo = getDiskInfo(pid);
-            proc.bytesRead = diskInfo.first;
-            proc.bytesWritten = diskInfo.second;
-            processes.push_back(proc);
+            ProcessCPUData &data = previousCPUData[ProcessKey{proc.PID, proc.startTime}];
+            updateIoRates(proc, data, sample, m_scanner.uptime());
         }
+        winners.push_back(proc);
     }
-
-    cleanupDeadProcesses(currentPIDs);
-    emit processesUpdated(processes);
+    processes.swap(winners);
 }
-
-
-
-
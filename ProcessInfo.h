@@ -2,53 +2,197 @@
 #define PROCESSINFO_H
 
 #include <QObject>
-#include <QTimer>
 #include <QString>
+#include <QHash>
+#include <QSet>
+#include <QVector>
 #include <vector>
-#include <QDir>
+#include "ProcConnector.h"
+#include "ProcScanner.h"
+#include "RingBuffer.h"
+#include "SampleScheduler.h"
 
 struct ProcessUsage
 {
     int PID;
+    int ppid;
     QString name;
     double cpuUsage;
     double ramUsage;
-    long bytesRead;
+    long bytesRead;    // cumulative, kept for the exit log
     long bytesWritten;
+    // Per second over the interval since io was last read, 0 until there are two reads
+    double readRate;
+    double writeRate;
+    double syscrRate;
+    double syscwRate;
+    double cancelledWriteRate;
+    int threads;
+    quint64 startTime; // clock ticks after boot, tells a reused PID from the process it replaced
 
 };
 
+// One task of the process selected for drill-down
+struct ThreadUsage
+{
+    int tid;
+    QString name;
+    char state;
+    int lastCpu;      // CPU the thread last ran on
+    double cpuUsage;  // percent of one core, 0 until the thread was seen twice
+};
+
+// A live process as the scan knows it, for consumers that only group processes, e.g. by cgroup
+struct ProcessIdentity
+{
+    int pid;
+    quint64 startTime;
+    QString name;
+};
+
+// Final totals of a process that disappeared between two scans
+struct ExitedProcess
+{
+    int PID;
+    quint64 startTime;   // with PID the identity of the process, see ProcessUsage
+    QString name;
+    double cpuSeconds;   // utime + stime over its whole life
+    long bytesRead;      // last values read from io, 0 if it was never readable
+    long bytesWritten;
+    double lifetime;     // seconds from start to the scan that missed it
+    qint64 exitTime;     // epoch ms of that scan
+};
+
 class ProcessInfo: public QObject
 {
     Q_OBJECT
 public:
+    // Ranking used by top-N mode. I/O ranks by time spent blocked on block I/O
+    // (delayacct_blkio_ticks in stat) since the byte counters live in the io file this mode skips.
+    // That field stays 0 unless kernel.task_delayacct is set, off by default since 5.14; without
+    // it io is read for every process and the rank is the read + write byte rate.
+    enum SortKey { ByCpu, ByRam, ByIo };
+
     explicit ProcessInfo(QObject *parent = nullptr);
     ~ProcessInfo() = default;
-    QString getProcessName(int pid);
-    double getCPUUsage(int pid);
-    double getRAMUsage(int pid);
-    std::pair<long, long> getDiskInfo(int pid);
 
-signals:
-    void processesUpdated(std::vector<ProcessUsage> processes);
+    void sample(const SampleTick &tick);
 
-private slots:
-    void updateProcessInfo();
+    // True while fork/exit events keep the PID list current and /proc is only listed to reconcile
+    bool isEventDriven() const { return m_connector != nullptr; }
+
+public slots:
+    // Threads used once /proc has ParallelThreshold or more PIDs, 1 keeps scans single threaded
+    void setScanWorkers(int workers);
+    // Emit only the count heaviest processes by key, io is then read for those alone.
+    // 0 emits every process.
+    void setTopN(int count, ProcessInfo::SortKey key);
+    // Read the tasks of pid on every sample from now on, 0 stops. Samples right away.
+    void setWatchedPid(int pid);
+
+signals:
+    void processesUpdated(std::vector<ProcessUsage> processes, const SampleTick &tick);
+    // Every PID in /proc and every task (thread) they own, counted during the regular scan
+    void totalsUpdated(int processes, int threads);
+    // Lifecycle between the previous scan and this one, not emitted for the first scan
+    void processesSpawned(const QVector<int> &pids, const SampleTick &tick);
+    void processesExited(const QVector<ExitedProcess> &exited, const SampleTick &tick);
+    // Every live process, sent after a scan that found, renamed or lost one while anything is connected
+    void processListChanged(const QVector<ProcessIdentity> &processes);
+    // Newest last, bounded to ExitLogSize entries
+    void exitLogUpdated(const QVector<ExitedProcess> &log);
+    // Tasks of the watched PID, empty once it exited
+    void threadsUpdated(int pid, const QVector<ThreadUsage> &threads, const SampleTick &tick);
 
 private:
-    QTimer *m_timer;
-    struct ProcessCPUData
+    static const int ExitLogSize = 100;
+    // With the proc connector /proc is still listed this often, in case events were missed
+    static const int ReconcileTicks = 60;
+
+    // A PID alone is not an identity, the kernel reuses them
+    struct ProcessKey
+    {
+        int pid;
+        quint64 startTime;
+
+        bool operator==(const ProcessKey &other) const
+        {
+            return pid == other.pid && startTime == other.startTime;
+        }
+    };
+    friend size_t qHash(const ProcessKey &key, size_t seed)
     {
-        double utime;
-        double stime;
-        double uptime;
+        return qHashMulti(seed, key.pid, key.startTime);
+    }
 
+    // State carried between scans to turn the stat counters into rates
+    struct ProcessCPUData
+    {
+        quint64 cpuTicks;   // utime + stime
+        quint64 blkioTicks;
+        quint64 generation; // last scan the process was seen in
+        // Last io values and the uptime they were read at, 0 while io was never read
+        long bytesRead;
+        long bytesWritten;
+        quint64 syscr;
+        quint64 syscw;
+        quint64 cancelledWriteBytes;
+        double ioUptime;
+        char comm[16];
+        QString name;       // converted once, reused while comm is unchanged
     };
 
-    QMap <int, ProcessCPUData> previousCPUData;
-    std::vector <QDir> getProcesses();
-    bool containsLetters(const QString &word);
-    void cleanupDeadProcesses(const std::vector<int>& currentPIDs);
+    void mergeSamples(const std::vector<ProcSample> &samples, std::vector<ProcessUsage> &processes);
+    void selectTop(const std::vector<ProcSample> &samples, std::vector<ProcessUsage> &processes);
+    void updateIoRates(ProcessUsage &proc, ProcessCPUData &data, const ProcSample &sample, double uptime);
+    void collectExits(double uptime, qint64 timestamp);
+    ExitedProcess exitFromSample(const ProcSample &sample, double uptime, qint64 timestamp) const;
+
+    void sampleThreads(const SampleTick &tick);
+
+    void onProcessForked(int pid);
+    void onProcessExeced(int pid);
+    void onProcessExited(int pid);
+
+    ProcScanner m_scanner;
+    QHash<ProcessKey, ProcessCPUData> previousCPUData;
+    RingBuffer<ExitedProcess> m_exitLog;
+    QVector<int> m_spawned;
+    QVector<ExitedProcess> m_exited;
+    bool m_listChanged; // since processListChanged was last sent
+    quint64 m_generation;
+    double m_lastUptime;
+    double m_clockTicks;
+    double m_pageSizeMB;
+    int m_pidCount;
+    int m_skippedCount;
+    int m_threadCount;
+
+    int m_topN;
+    SortKey m_sortKey;
+    bool m_delayAcct; // kernel.task_delayacct as of the last setTopN
+    // Per emitted process from the last merge: ranking key and index into the scan samples
+    std::vector<double> m_rankKeys;
+    std::vector<int> m_sampleIndex;
+    std::vector<int> m_order;
+
+    // Event-driven mode, nullptr when the connector is unavailable and every tick lists /proc
+    ProcConnector *m_connector;
+    QSet<int> m_livePids;
+    std::vector<int> m_livePidList;
+    bool m_needReconcile;
+    int m_ticksSinceReconcile;
+    // Last stat (and io on exit) read when an exec or exit event arrived, so processes that live
+    // and die between two ticks still reach the exit log with their name and final totals
+    QHash<int, ProcSample> m_eventSamples;
+    QVector<int> m_exitedPids;
+
+    // Thread drill-down, only the watched PID's task directory is ever read
+    int m_watchedPid;
+    quint64 m_watchedStartTime;
+    QHash<int, quint64> m_threadTicks; // utime + stime per TID at m_threadUptime
+    double m_threadUptime;
+    std::vector<int> m_tids;
 
 
 };
@@ -0,0 +1,219 @@
+#include "ProcessTableModel.h"
+#include "CounterRate.h"
+
+namespace {
+// PIDs stay below 2^22 (PID_MAX_LIMIT), so the start time fits above them
+quint64 identity(const ProcessUsage &proc)
+{
+    return (proc.startTime << 22) | static_cast<quint64>(proc.PID);
+}
+} // namespace
+
+ProcessTableModel::ProcessTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{}
+
+int ProcessTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int ProcessTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ProcessTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) {
+        return QVariant();
+    }
+
+    const ProcessUsage &proc = m_rows[index.row()];
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case PidColumn:
+            return QString::number(proc.PID);
+        case NameColumn:
+            return proc.name;
+        case CpuColumn:
+            return QString::number(proc.cpuUsage, 'f', 2);
+        case RamColumn:
+            return QString::number(proc.ramUsage, 'f', 2) + " MB";
+        case IoColumn:
+            return "R " + CounterRate::formatRate(proc.readRate) + "  W " + CounterRate::formatRate(proc.writeRate);
+        case SyscallColumn:
+            return QString("r %1  w %2").arg(proc.syscrRate, 0, 'f', 0).arg(proc.syscwRate, 0, 'f', 0);
+        }
+    } else if (role == SortRole) {
+        switch (index.column()) {
+        case PidColumn:
+            return proc.PID;
+        case NameColumn:
+            return proc.name;
+        case CpuColumn:
+            return proc.cpuUsage;
+        case RamColumn:
+            return proc.ramUsage;
+        case IoColumn:
+            // Like iotop, heaviest current disk traffic first
+            return proc.readRate + proc.writeRate;
+        case SyscallColumn:
+            return proc.syscrRate + proc.syscwRate;
+        }
+    } else if (role == Qt::ToolTipRole && index.column() == IoColumn) {
+        return QString("Read: %1 bytes total\nWritten: %2 bytes total\nCancelled writes: %3")
+            .arg(proc.bytesRead)
+            .arg(proc.bytesWritten)
+            .arg(CounterRate::formatRate(proc.cancelledWriteRate));
+    } else if (role == Qt::TextAlignmentRole && index.column() != NameColumn) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+}
+
+QVariant ProcessTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case PidColumn:
+        return "PID";
+    case NameColumn:
+        return "Name";
+    case CpuColumn:
+        return "CPU %";
+    case RamColumn:
+        return "RAM";
+    case IoColumn:
+        return "Disk I/O";
+    case SyscallColumn:
+        return "Syscalls/s";
+    }
+    return QVariant();
+}
+
+int ProcessTableModel::pidAt(int row) const
+{
+    return (row >= 0 && row < static_cast<int>(m_rows.size())) ? m_rows[row].PID : -1;
+}
+
+void ProcessTableModel::setProcesses(const std::vector<ProcessUsage> &processes)
+{
+    QHash<quint64, int> incoming;
+    incoming.reserve(static_cast<int>(processes.size()));
+    for (int i = 0; i < static_cast<int>(processes.size()); ++i) {
+        incoming.insert(identity(processes[i]), i);
+    }
+
+    removeMissing(incoming);
+
+    // Update surviving rows in place, one dataChanged per run of consecutive changed rows
+    int runStart = -1;
+    for (int row = 0; row <= static_cast<int>(m_rows.size()); ++row) {
+        bool changed = false;
+        if (row < static_cast<int>(m_rows.size())) {
+            ProcessUsage &current = m_rows[row];
+            const ProcessUsage &next = processes[incoming.value(identity(current))];
+            changed = current.cpuUsage != next.cpuUsage || current.ramUsage != next.ramUsage
+                      || current.readRate != next.readRate || current.writeRate != next.writeRate
+                      || current.syscrRate != next.syscrRate || current.syscwRate != next.syscwRate
+                      || current.cancelledWriteRate != next.cancelledWriteRate || current.name != next.name
+                      || current.threads != next.threads;
+            if (changed) {
+                current = next;
+            }
+        }
+
+        if (changed && runStart < 0) {
+            runStart = row;
+        } else if (!changed && runStart >= 0) {
+            emit dataChanged(index(runStart, 0), index(row - 1, ColumnCount - 1));
+            runStart = -1;
+        }
+    }
+
+    // New processes are appended in one insert, the proxy places them by its sort order
+    std::vector<int> added;
+    for (int i = 0; i < static_cast<int>(processes.size()); ++i) {
+        if (!m_rowForProcess.contains(identity(processes[i]))) {
+            added.push_back(i);
+        }
+    }
+    if (!added.empty()) {
+        const int first = static_cast<int>(m_rows.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(added.size()) - 1);
+        for (int i : added) {
+            m_rowForProcess.insert(identity(processes[i]), static_cast<int>(m_rows.size()));
+            m_rows.push_back(processes[i]);
+        }
+        endInsertRows();
+    }
+}
+
+void ProcessTableModel::removeMissing(const QHash<quint64, int> &incoming)
+{
+    // Walk backwards so earlier row numbers stay valid, one remove per run of exited processes
+    bool removed = false;
+    int row = static_cast<int>(m_rows.size()) - 1;
+    while (row >= 0) {
+        if (incoming.contains(identity(m_rows[row]))) {
+            --row;
+            continue;
+        }
+
+        const int last = row;
+        while (row > 0 && !incoming.contains(identity(m_rows[row - 1]))) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        m_rows.erase(m_rows.begin() + row, m_rows.begin() + last + 1);
+        endRemoveRows();
+        removed = true;
+        --row;
+    }
+
+    if (removed || m_rowForProcess.size() != static_cast<int>(m_rows.size())) {
+        rebuildIndex();
+    }
+}
+
+void ProcessTableModel::rebuildIndex()
+{
+    m_rowForProcess.clear();
+    m_rowForProcess.reserve(static_cast<int>(m_rows.size()));
+    for (int row = 0; row < static_cast<int>(m_rows.size()); ++row) {
+        m_rowForProcess.insert(identity(m_rows[row]), row);
+    }
+}
+
+ProcessFilterProxyModel::ProcessFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    setSortRole(ProcessTableModel::SortRole);
+}
+
+void ProcessFilterProxyModel::setFilterText(const QString &text)
+{
+    const QString trimmed = text.trimmed();
+    if (trimmed == m_filterText) {
+        return;
+    }
+    m_filterText = trimmed;
+    invalidateFilter();
+}
+
+bool ProcessFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    const QString &text = m_filterText;
+    if (text.isEmpty()) {
+        return true;
+    }
+
+    const QAbstractItemModel *model = sourceModel();
+    const QString name = model->index(sourceRow, ProcessTableModel::NameColumn, sourceParent).data().toString();
+    const QString pid = model->index(sourceRow, ProcessTableModel::PidColumn, sourceParent).data().toString();
+    return name.contains(text, Qt::CaseInsensitive) || pid.startsWith(text);
+}
@@ -0,0 +1,61 @@
+#ifndef PROCESSTABLEMODEL_H
+#define PROCESSTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSortFilterProxyModel>
+#include <vector>
+#include "ProcessInfo.h"
+
+// Rows of the last process snapshot keyed by PID and start time. Each update is diffed against the current rows
+// so views only see removes, inserts and dataChanged for what actually changed, which keeps the
+// selection, scroll position and sort of attached views intact.
+class ProcessTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { PidColumn, NameColumn, CpuColumn, RamColumn, IoColumn, SyscallColumn, ColumnCount };
+
+    // Raw value for the proxy to sort on, DisplayRole is formatted text
+    static const int SortRole = Qt::UserRole;
+
+    explicit ProcessTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void setProcesses(const std::vector<ProcessUsage> &processes);
+
+    // -1 when the row is out of range
+    int pidAt(int row) const;
+
+private:
+    void removeMissing(const QHash<quint64, int> &incoming);
+    void rebuildIndex();
+
+    std::vector<ProcessUsage> m_rows;
+    QHash<quint64, int> m_rowForProcess; // identity() -> row
+};
+
+// Sorts on ProcessTableModel::SortRole and matches the filter text against the name or PID
+class ProcessFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit ProcessFilterProxyModel(QObject *parent = nullptr);
+
+public slots:
+    void setFilterText(const QString &text);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QString m_filterText;
+};
+
+#endif // PROCESSTABLEMODEL_H
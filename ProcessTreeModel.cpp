@@ -0,0 +1,335 @@
+#include "ProcessTreeModel.h"
+#include "CounterRate.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+// Incremental sums drift by rounding, never show that as a negative value
+double clampZero(double value)
+{
+    return value < 0.0 ? 0.0 : value;
+}
+} // namespace
+
+ProcessTreeModel::ProcessTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{}
+
+ProcessTreeModel::~ProcessTreeModel()
+{
+    qDeleteAll(m_nodes);
+}
+
+ProcessTreeModel::Totals ProcessTreeModel::totalsOf(const ProcessUsage &proc)
+{
+    return Totals{proc.cpuUsage, proc.ramUsage, proc.readRate + proc.writeRate};
+}
+
+QModelIndex ProcessTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column < 0 || column >= ColumnCount || (parent.isValid() && parent.column() != 0)) {
+        return QModelIndex();
+    }
+
+    Node *parentNode = parent.isValid() ? static_cast<Node *>(parent.internalPointer()) : nullptr;
+    const QVector<Node *> &list = parentNode ? parentNode->children : m_roots;
+    if (row < 0 || row >= list.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, list[row]);
+}
+
+QModelIndex ProcessTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    return indexFor(static_cast<Node *>(child.internalPointer())->parent);
+}
+
+int ProcessTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_roots.size();
+    }
+    if (parent.column() != 0) {
+        return 0;
+    }
+    return static_cast<Node *>(parent.internalPointer())->children.size();
+}
+
+int ProcessTreeModel::columnCount(const QModelIndex &) const
+{
+    return ColumnCount;
+}
+
+QVariant ProcessTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const Node *node = static_cast<Node *>(index.internalPointer());
+    const ProcessUsage &proc = node->proc;
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn:
+            return proc.name;
+        case PidColumn:
+            return QString::number(proc.PID);
+        case CpuColumn:
+            return QString::number(proc.cpuUsage, 'f', 2);
+        case TreeCpuColumn:
+            return QString::number(clampZero(node->subtree.cpu), 'f', 2);
+        case TreeRamColumn:
+            return QString::number(clampZero(node->subtree.ram), 'f', 2) + " MB";
+        case TreeIoColumn:
+            return CounterRate::formatRate(clampZero(node->subtree.io));
+        }
+    } else if (role == SortRole) {
+        switch (index.column()) {
+        case NameColumn:
+            return proc.name;
+        case PidColumn:
+            return proc.PID;
+        case CpuColumn:
+            return proc.cpuUsage;
+        case TreeCpuColumn:
+            return node->subtree.cpu;
+        case TreeRamColumn:
+            return node->subtree.ram;
+        case TreeIoColumn:
+            return node->subtree.io;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        return QString("%1 (%2)\nSelf: %3% CPU, %4 MB, %5\nChildren: %6")
+            .arg(proc.name)
+            .arg(proc.PID)
+            .arg(proc.cpuUsage, 0, 'f', 2)
+            .arg(proc.ramUsage, 0, 'f', 2)
+            .arg(CounterRate::formatRate(proc.readRate + proc.writeRate))
+            .arg(node->children.size());
+    } else if (role == Qt::TextAlignmentRole && index.column() != NameColumn) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+}
+
+QVariant ProcessTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractItemModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case NameColumn:
+        return "Name";
+    case PidColumn:
+        return "PID";
+    case CpuColumn:
+        return "CPU %";
+    case TreeCpuColumn:
+        return "Tree CPU %";
+    case TreeRamColumn:
+        return "Tree RAM";
+    case TreeIoColumn:
+        return "Tree Disk I/O";
+    }
+    return QVariant();
+}
+
+QModelIndex ProcessTreeModel::indexFor(Node *node, int column) const
+{
+    return node ? createIndex(node->row, column, node) : QModelIndex();
+}
+
+ProcessTreeModel::Node *ProcessTreeModel::desiredParent(Node *node) const
+{
+    Node *parent = m_nodes.value(node->proc.ppid, nullptr);
+    // ppid races during reparenting must never build a cycle
+    for (Node *ancestor = parent; ancestor; ancestor = ancestor->parent) {
+        if (ancestor == node) {
+            return nullptr;
+        }
+    }
+    return parent;
+}
+
+void ProcessTreeModel::addToAncestors(Node *from, const Totals &delta, double sign)
+{
+    for (Node *node = from; node; node = node->parent) {
+        node->subtree.cpu += sign * delta.cpu;
+        node->subtree.ram += sign * delta.ram;
+        node->subtree.io += sign * delta.io;
+        m_touched.insert(node);
+    }
+}
+
+void ProcessTreeModel::takeFromSiblings(Node *node)
+{
+    QVector<Node *> &list = siblings(node->parent);
+    list.removeAt(node->row);
+    for (int row = node->row; row < list.size(); ++row) {
+        list[row]->row = row;
+    }
+}
+
+void ProcessTreeModel::attach(Node *node, Node *parent)
+{
+    QVector<Node *> &list = siblings(parent);
+    const int row = list.size();
+    beginInsertRows(indexFor(parent), row, row);
+    node->parent = parent;
+    node->row = row;
+    list.append(node);
+    endInsertRows();
+
+    addToAncestors(parent, node->subtree, 1.0);
+    markOrphan(node);
+}
+
+void ProcessTreeModel::markOrphan(Node *node)
+{
+    if (!node->parent && node->proc.ppid != 0 && !m_orphans.contains(node->proc.ppid, node)) {
+        m_orphans.insert(node->proc.ppid, node);
+    }
+}
+
+void ProcessTreeModel::moveNode(Node *node, Node *newParent)
+{
+    Node *oldParent = node->parent;
+    if (oldParent == newParent) {
+        return;
+    }
+
+    const int destination = siblings(newParent).size();
+    if (!beginMoveRows(indexFor(oldParent), node->row, node->row, indexFor(newParent), destination)) {
+        return;
+    }
+    takeFromSiblings(node);
+    node->parent = newParent;
+    node->row = destination;
+    siblings(newParent).append(node);
+    endMoveRows();
+
+    addToAncestors(oldParent, node->subtree, -1.0);
+    addToAncestors(newParent, node->subtree, 1.0);
+
+    m_orphans.remove(node->proc.ppid, node);
+    markOrphan(node);
+}
+
+void ProcessTreeModel::removeNode(Node *node)
+{
+    // Surviving children wait at the root until their new ppid (a subreaper or init) shows up
+    while (!node->children.isEmpty()) {
+        moveNode(node->children.last(), nullptr);
+    }
+
+    Node *parent = node->parent;
+    beginRemoveRows(indexFor(parent), node->row, node->row);
+    takeFromSiblings(node);
+    endRemoveRows();
+
+    addToAncestors(parent, node->subtree, -1.0);
+    m_touched.remove(node);
+    m_orphans.remove(node->proc.ppid, node);
+    m_nodes.remove(node->proc.PID);
+    delete node;
+}
+
+void ProcessTreeModel::setProcesses(const std::vector<ProcessUsage> &processes)
+{
+    m_touched.clear();
+
+    std::vector<const ProcessUsage *> added;
+    std::vector<Node *> replaced;
+    std::vector<Node *> reparent;
+
+    // Known processes: push only the change of their own values up the tree
+    for (const ProcessUsage &proc : processes) {
+        Node *node = m_nodes.value(proc.PID, nullptr);
+        if (!node || node->proc.startTime != proc.startTime) {
+            // A reused PID, its old owner exited since the last update
+            if (node) {
+                replaced.push_back(node);
+            }
+            added.push_back(&proc);
+            continue;
+        }
+
+        const Totals self = totalsOf(proc);
+        const Totals delta{self.cpu - node->self.cpu, self.ram - node->self.ram, self.io - node->self.io};
+        const bool changed = !delta.isZero() || node->proc.name != proc.name;
+        if (node->proc.ppid != proc.ppid) {
+            // Registered again under the new ppid once it is placed
+            m_orphans.remove(node->proc.ppid, node);
+            reparent.push_back(node);
+        }
+        node->proc = proc;
+        node->self = self;
+        if (!delta.isZero()) {
+            addToAncestors(node, delta, 1.0);
+        } else if (changed) {
+            m_touched.insert(node);
+        }
+    }
+
+    for (Node *node : replaced) {
+        removeNode(node);
+    }
+
+    // Parents start before their children, so attaching in start order finds them already placed
+    std::sort(added.begin(), added.end(), [](const ProcessUsage *a, const ProcessUsage *b) {
+        return a->startTime < b->startTime;
+    });
+    for (const ProcessUsage *proc : added) {
+        Node *node = new Node;
+        node->proc = *proc;
+        node->parent = nullptr;
+        node->row = 0;
+        node->self = totalsOf(*proc);
+        node->subtree = node->self;
+        m_nodes.insert(proc->PID, node);
+        attach(node, desiredParent(node));
+        m_touched.insert(node);
+    }
+
+    // Orphans are only looked at when the parent they wait for has shown up
+    for (const ProcessUsage *proc : added) {
+        for (auto it = m_orphans.constFind(proc->PID); it != m_orphans.cend() && it.key() == proc->PID; ++it) {
+            reparent.push_back(it.value());
+        }
+    }
+    for (Node *node : reparent) {
+        Node *parent = desiredParent(node);
+        if (parent != node->parent) {
+            moveNode(node, parent);
+        } else {
+            markOrphan(node);
+        }
+    }
+
+    emitTouched();
+}
+
+void ProcessTreeModel::removeProcesses(const QVector<ExitedProcess> &exited)
+{
+    m_touched.clear();
+    for (const ExitedProcess &process : exited) {
+        Node *node = m_nodes.value(process.PID, nullptr);
+        // A PID already taken over by a newer process keeps its node
+        if (node && node->proc.startTime == process.startTime) {
+            removeNode(node);
+        }
+    }
+    emitTouched();
+}
+
+void ProcessTreeModel::emitTouched()
+{
+    for (Node *node : std::as_const(m_touched)) {
+        emit dataChanged(indexFor(node, 0), indexFor(node, ColumnCount - 1));
+    }
+    m_touched.clear();
+}
@@ -0,0 +1,83 @@
+#ifndef PROCESSTREEMODEL_H
+#define PROCESSTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
+#include <QVector>
+#include <vector>
+#include "ProcessInfo.h"
+
+// Parent/child tree of the process snapshot built from ppid, with CPU, RSS and disk I/O rolled up
+// per subtree. The tree is kept across updates: only processes that changed, appeared, exited or
+// were reparented touch the model, and their deltas are pushed up their ancestor chain, so a tick
+// costs O(changed nodes x depth) instead of re-summing every subtree.
+class ProcessTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn, PidColumn, CpuColumn, TreeCpuColumn, TreeRamColumn, TreeIoColumn, ColumnCount };
+
+    // Raw value for the proxy to sort on, DisplayRole is formatted text
+    static const int SortRole = Qt::UserRole;
+
+    explicit ProcessTreeModel(QObject *parent = nullptr);
+    ~ProcessTreeModel();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Needs the full process list, a top-N snapshot would orphan most of the tree. Exits are not
+    // inferred from what is missing, they come through removeProcesses.
+    void setProcesses(const std::vector<ProcessUsage> &processes);
+    // Feed every ProcessInfo::processesExited, also while the tree is not being updated
+    void removeProcesses(const QVector<ExitedProcess> &exited);
+
+private:
+    struct Totals
+    {
+        double cpu;
+        double ram;
+        double io; // bytes/s read + written
+
+        bool isZero() const { return cpu == 0.0 && ram == 0.0 && io == 0.0; }
+    };
+
+    struct Node
+    {
+        ProcessUsage proc;
+        Node *parent;
+        QVector<Node *> children;
+        int row;          // position in parent->children (or m_roots)
+        Totals self;
+        Totals subtree;   // self plus every descendant
+    };
+
+    static Totals totalsOf(const ProcessUsage &proc);
+
+    QVector<Node *> &siblings(Node *parent) { return parent ? parent->children : m_roots; }
+    QModelIndex indexFor(Node *node, int column = 0) const;
+    Node *desiredParent(Node *node) const;
+
+    void addToAncestors(Node *from, const Totals &delta, double sign);
+    void attach(Node *node, Node *parent);
+    void removeNode(Node *node);
+    void moveNode(Node *node, Node *newParent);
+    void takeFromSiblings(Node *node);
+    void markOrphan(Node *node);
+    void emitTouched();
+
+    QHash<int, Node *> m_nodes;   // by PID
+    QVector<Node *> m_roots;
+    // At the root only because their parent was not known yet, by the ppid they wait for
+    QMultiHash<int, Node *> m_orphans;
+    QSet<Node *> m_touched;       // rows whose display changed during the current update
+};
+
+#endif // PROCESSTREEMODEL_H
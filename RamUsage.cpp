@@ -15,14 +15,10 @@ RamUsage::RamUsage(QObject *parent)
     , pagedPool(0)
     , nonPagedPool(0)
 {
-    m_Timer = new QTimer(this);
-    connect(m_Timer, &QTimer::timeout, this, &RamUsage::updateRamUsage);
-    m_Timer -> start(1000);
-
-    updateRamUsage();
+    sample(SampleTick::now());
 }
 
-void RamUsage::updateRamUsage()
+void RamUsage::sample(const SampleTick &tick)
 {
     QFile file("/proc/meminfo");
     if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -83,7 +79,17 @@ void RamUsage::updateRamUsage()
     if (totalSysRam > 0)
     {
         totalUsedRam = totalSysRam - availableRam;
-        emit ramUsageUpdated(totalUsedRam);
+
+        RamInfo info;
+        info.totalKB = totalSysRam;
+        info.usedKB = totalUsedRam;
+        info.availableKB = availableRam;
+        info.buffersKB = buffers;
+        info.cachedKB = cachedRam;
+        info.pagedPoolKB = pagedPool;
+        info.nonPagedPoolKB = nonPagedPool;
+        info.tick = tick;
+        emit ramUsageUpdated(info);
     }
     else
     {
@@ -92,15 +98,15 @@ void RamUsage::updateRamUsage()
 
 }
 
-QString RamUsage::getRamUsageString() const
+QString RamUsage::getRamUsageString(const RamInfo &info)
 {
-    double usedGB = totalUsedRam / (1024.0 * 1024.0);
-    double totalGB = totalSysRam / (1024.0 * 1024.0);
+    double usedGB = info.usedKB / (1024.0 * 1024.0);
+    double totalGB = info.totalKB / (1024.0 * 1024.0);
     double usedPercentage = (totalGB > 0.0) ? (usedGB * 100.0) / totalGB : 0.0;
-    double availableGB = (availableRam) / (1024.0 * 1024.0);
-    double cachedGB = cachedRam / (1024.0 * 1024.0);
-    double pagedGB = pagedPool / (1024.0  * 1024.0);
-    double nonPagedGB = nonPagedPool / (1024.0  * 1024.0);
+    double availableGB = (info.availableKB) / (1024.0 * 1024.0);
+    double cachedGB = info.cachedKB / (1024.0 * 1024.0);
+    double pagedGB = info.pagedPoolKB / (1024.0  * 1024.0);
+    double nonPagedGB = info.nonPagedPoolKB / (1024.0  * 1024.0);
 
 
     return QString("Memory Used: %1 GB/ %2 GB (%3%)\n"
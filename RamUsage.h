@@ -4,7 +4,20 @@
 
 #include <QObject>
 #include <QString>
-#include <QTimer>
+#include "SampleScheduler.h"
+
+// Snapshot of /proc/meminfo handed to the widgets, all values in KB
+struct RamInfo
+{
+    long totalKB;
+    long usedKB;
+    long availableKB;
+    long buffersKB;
+    long cachedKB;
+    long pagedPoolKB;
+    long nonPagedPoolKB;
+    SampleTick tick;
+};
 
 class RamUsage : public QObject
 {
@@ -14,20 +27,17 @@ public:
     explicit RamUsage(QObject *parent = nullptr);
     ~RamUsage() = default;
 
-    QString getRamUsageString() const;
+    static QString getRamUsageString(const RamInfo &info);
     long getCurrentRamUsage() const {return totalUsedRam;}
     long getTotalSysRam() const {return totalSysRam;}
 
+    void sample(const SampleTick &tick);
 
-signals:
-    void ramUsageUpdated(long usedRamKB);
 
-private slots:
-    void updateRamUsage();
+signals:
+    void ramUsageUpdated(const RamInfo &info);
 
 private:
-    QTimer *m_Timer;
-
     long totalUsedRam;
     long totalSysRam;
     long buffers;
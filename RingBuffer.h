@@ -0,0 +1,102 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QVector>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity history with O(1) push. Every value is written twice (slot i and i + capacity),
+// so the live window oldest -> newest is always one contiguous span and painters can walk it as a
+// plain array without unwrapping.
+template<typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(int capacity = 0)
+    {
+        reset(capacity);
+    }
+
+    RingBuffer(int capacity, const T &value)
+    {
+        reset(capacity);
+        fill(value);
+    }
+
+    // Drops all values and changes the capacity
+    void reset(int capacity)
+    {
+        m_capacity = capacity > 0 ? capacity : 0;
+        m_buffer.assign(static_cast<std::size_t>(m_capacity) * 2, T());
+        m_head = 0;
+        m_size = 0;
+    }
+
+    // Changes the capacity, keeping the newest values that still fit
+    void resize(int capacity)
+    {
+        if (capacity == m_capacity) {
+            return;
+        }
+        const std::vector<T> kept(begin() + (m_size > capacity ? m_size - capacity : 0), end());
+        reset(capacity);
+        for (const T &value : kept) {
+            push(value);
+        }
+    }
+
+    // Fills every slot, the buffer is full afterwards
+    void fill(const T &value)
+    {
+        std::fill(m_buffer.begin(), m_buffer.end(), value);
+        m_head = 0;
+        m_size = m_capacity;
+    }
+
+    void clear()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    // Appends a value, overwriting the oldest one once full
+    void push(const T &value)
+    {
+        if (m_capacity == 0) {
+            return;
+        }
+        m_buffer[m_head] = value;
+        m_buffer[m_head + m_capacity] = value;
+        m_head = m_head + 1 == m_capacity ? 0 : m_head + 1;
+        if (m_size < m_capacity) {
+            m_size++;
+        }
+    }
+
+    int size() const { return m_size; }
+    int capacity() const { return m_capacity; }
+    bool isEmpty() const { return m_size == 0; }
+    bool isFull() const { return m_size == m_capacity; }
+
+    // Contiguous view of the live values, oldest first
+    const T *data() const { return m_buffer.data() + m_head + m_capacity - m_size; }
+    const T *begin() const { return data(); }
+    const T *end() const { return data() + m_size; }
+
+    // 0 is the oldest value
+    const T &at(int index) const { return data()[index]; }
+    const T &operator[](int index) const { return data()[index]; }
+    const T &first() const { return at(0); }
+    const T &last() const { return at(m_size - 1); }
+
+    QVector<T> toVector() const { return QVector<T>(begin(), end()); }
+
+private:
+    std::vector<T> m_buffer;
+    int m_capacity = 0;
+    int m_head = 0; // next slot to write, in [0, capacity)
+    int m_size = 0;
+};
+
+#endif // RINGBUFFER_H
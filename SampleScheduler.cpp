@@ -0,0 +1,122 @@
+#include "SampleScheduler.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QSocketNotifier>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+qint64 monotonicNowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+timespec toTimespec(qint64 ns)
+{
+    timespec ts;
+    ts.tv_sec = ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    return ts;
+}
+} // namespace
+
+SampleTick SampleTick::now()
+{
+    return {0, monotonicNowNs(), QDateTime::currentMSecsSinceEpoch()};
+}
+
+SampleScheduler::SampleScheduler(int periodMs, QObject *parent)
+    : QObject(parent)
+    , m_periodMs(periodMs)
+    , m_timerFd(-1)
+    , m_startNs(0)
+    , m_sequence(0)
+    , m_notifier(nullptr)
+{}
+
+SampleScheduler::~SampleScheduler()
+{
+    delete m_notifier;
+    if (m_timerFd >= 0) {
+        ::close(m_timerFd);
+    }
+}
+
+void SampleScheduler::start()
+{
+    m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_timerFd < 0) {
+        qWarning() << "timerfd_create failed, sampling is disabled";
+        return;
+    }
+
+    // First deadline on the next whole period of the monotonic clock, then strictly periodic
+    const qint64 periodNs = static_cast<qint64>(m_periodMs) * 1000000;
+    m_startNs = (monotonicNowNs() / periodNs + 1) * periodNs;
+
+    itimerspec spec;
+    spec.it_value = toTimespec(m_startNs);
+    spec.it_interval = toTimespec(periodNs);
+    timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+    m_notifier = new QSocketNotifier(m_timerFd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &SampleScheduler::onTimer);
+}
+
+void SampleScheduler::subscribe(QObject *collector,
+                                int cadenceTicks,
+                                std::function<void(const SampleTick &)> sample)
+{
+    Subscriber subscriber{collector, qMax(1, cadenceTicks), std::move(sample)};
+    QMetaObject::invokeMethod(
+        this,
+        [this, subscriber]() { m_subscribers.append(subscriber); },
+        Qt::QueuedConnection);
+}
+
+void SampleScheduler::setCadence(QObject *collector, int cadenceTicks)
+{
+    QMetaObject::invokeMethod(
+        this,
+        [this, collector, cadenceTicks]() {
+            for (Subscriber &subscriber : m_subscribers) {
+                if (subscriber.collector == collector) {
+                    subscriber.cadenceTicks = qMax(1, cadenceTicks);
+                }
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+void SampleScheduler::onTimer()
+{
+    quint64 expirations = 0;
+    if (::read(m_timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)
+        || expirations == 0) {
+        return;
+    }
+
+    // Missed deadlines still advance the sequence so cadences stay on the same grid
+    m_sequence += expirations;
+
+    SampleTick tick;
+    tick.sequence = m_sequence;
+    tick.monotonicNs = m_startNs + static_cast<qint64>(m_sequence - 1) * m_periodMs * 1000000;
+    tick.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    for (int i = 0; i < m_subscribers.size();) {
+        Subscriber &subscriber = m_subscribers[i];
+        if (!subscriber.collector) {
+            m_subscribers.removeAt(i);
+            continue;
+        }
+        // Slow collectors fire when the sequence crosses their cadence, even across missed ticks
+        if ((m_sequence / subscriber.cadenceTicks) != ((m_sequence - expirations) / subscriber.cadenceTicks)) {
+            subscriber.sample(tick);
+        }
+        ++i;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef SAMPLESCHEDULER_H
+#define SAMPLESCHEDULER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <functional>
+
+class QSocketNotifier;
+
+// One scheduler tick, shared by every collector sampled on it so their snapshots line up exactly
+struct SampleTick
+{
+    quint64 sequence;   // ticks since the scheduler started, counts missed ticks too
+    qint64 monotonicNs; // CLOCK_MONOTONIC deadline the tick was scheduled for
+    qint64 timestamp;   // wall clock in ms since epoch, one value per tick
+
+    // Stamp for samples taken outside the scheduler, e.g. a collector's baseline read
+    static SampleTick now();
+};
+
+// Drives all collectors from a single timerfd armed on absolute CLOCK_MONOTONIC deadlines, so the
+// process wakes up once per period instead of once per collector and samples never drift apart.
+// Lives on the sampler thread.
+class SampleScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SampleScheduler(int periodMs = 1000, QObject *parent = nullptr);
+    ~SampleScheduler();
+
+    int periodMs() const { return m_periodMs; }
+
+    // Calls sample every cadenceTicks ticks until collector is destroyed. Safe to call from any
+    // thread, the subscription is added on the scheduler's thread.
+    void subscribe(QObject *collector, int cadenceTicks, std::function<void(const SampleTick &)> sample);
+    void setCadence(QObject *collector, int cadenceTicks);
+
+public slots:
+    void start();
+
+private:
+    struct Subscriber
+    {
+        QPointer<QObject> collector;
+        int cadenceTicks;
+        std::function<void(const SampleTick &)> sample;
+    };
+
+    void onTimer();
+
+    int m_periodMs;
+    int m_timerFd;
+    qint64 m_startNs;
+    quint64 m_sequence;
+    QSocketNotifier *m_notifier;
+    QVector<Subscriber> m_subscribers;
+};
+
+#endif // SAMPLESCHEDULER_H
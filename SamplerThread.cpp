@@ -0,0 +1,38 @@
+#include "SamplerThread.h"
+
+namespace {
+SamplerThread *s_instance = nullptr;
+}
+
+SamplerThread::SamplerThread(QObject *parent)
+    : QObject(parent)
+    , m_scheduler(new SampleScheduler(1000))
+{
+    s_instance = this;
+    m_thread.setObjectName("Sampler");
+    moveToSampler(m_scheduler);
+    m_thread.start();
+
+    // The timerfd and its notifier have to be created on the thread that polls them
+    QMetaObject::invokeMethod(m_scheduler, &SampleScheduler::start, Qt::QueuedConnection);
+}
+
+SamplerThread::~SamplerThread()
+{
+    // Collectors are deleted by the finished() -> deleteLater() connections made in moveToSampler()
+    m_thread.quit();
+    m_thread.wait();
+    s_instance = nullptr;
+}
+
+SamplerThread *SamplerThread::instance()
+{
+    return s_instance;
+}
+
+void SamplerThread::moveToSampler(QObject *collector)
+{
+    Q_ASSERT(!collector->parent());
+    collector->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, collector, &QObject::deleteLater);
+}
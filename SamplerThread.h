@@ -0,0 +1,41 @@
+#ifndef SAMPLERTHREAD_H
+#define SAMPLERTHREAD_H
+
+#include <QObject>
+#include <QThread>
+#include "SampleScheduler.h"
+
+// Owns the thread every collector samples on. Collectors are created on the GUI thread, wired to
+// their widgets and then adopted; from then on the scheduler ticks them and their /proc reads run
+// here, and widgets only see the snapshots they emit through queued signals.
+class SamplerThread : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SamplerThread(QObject *parent = nullptr);
+    ~SamplerThread();
+
+    static SamplerThread *instance();
+
+    SampleScheduler *scheduler() const { return m_scheduler; }
+
+    // Moves a parentless collector onto the sampler thread and calls its sample(const SampleTick &)
+    // every cadenceTicks scheduler ticks. It is deleted when the thread stops.
+    template<typename Collector>
+    void adopt(Collector *collector, int cadenceTicks = 1)
+    {
+        moveToSampler(collector);
+        m_scheduler->subscribe(collector, cadenceTicks, [collector](const SampleTick &tick) {
+            collector->sample(tick);
+        });
+    }
+
+private:
+    void moveToSampler(QObject *collector);
+
+    QThread m_thread;
+    SampleScheduler *m_scheduler;
+};
+
+#endif // SAMPLERTHREAD_H
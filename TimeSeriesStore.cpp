@@ -0,0 +1,131 @@
+#include "TimeSeriesStore.h"
+#include <QtGlobal>
+
+TimeSeriesStore::TimeSeriesStore()
+{
+    // 10 min of raw samples serve the 1, 5 and 10 min windows at full resolution, so a short
+    // spike stays a single sample until it is older than that. 1 h of 1 min and 24 h of 24 min
+    // rollups keep min/max, so spikes survive there as the bucket max.
+    m_raw.reset(RawSamples);
+
+    for (int i = 0; i < WindowCount; ++i) {
+        const Window window = static_cast<Window>(i);
+        m_tiers[i].bucketSamples = bucketSeconds(window);
+        m_tiers[i].buckets.reset(fromRaw(window) ? 0 : PointsPerWindow);
+        m_tiers[i].count = 0;
+    }
+}
+
+void TimeSeriesStore::add(double value)
+{
+    m_raw.push(value);
+    m_added++;
+
+    // O(tiers) per sample, every tier rolls up straight from the raw value
+    for (Tier &tier : m_tiers) {
+        if (tier.buckets.capacity() == 0) {
+            continue;
+        }
+        if (tier.count == 0) {
+            tier.min = value;
+            tier.max = value;
+            tier.sum = 0.0;
+        }
+        tier.min = qMin(tier.min, value);
+        tier.max = qMax(tier.max, value);
+        tier.sum += value;
+        tier.count++;
+
+        if (tier.count == tier.bucketSamples) {
+            tier.buckets.push({tier.min, tier.max, tier.sum / tier.count});
+            tier.count = 0;
+        }
+    }
+}
+
+void TimeSeriesStore::clear()
+{
+    m_raw.clear();
+    m_added = 0;
+    for (Tier &tier : m_tiers) {
+        tier.buckets.clear();
+        tier.count = 0;
+    }
+}
+
+bool TimeSeriesStore::fromRaw(Window window)
+{
+    return bucketSeconds(window) * PointsPerWindow <= RawSamples;
+}
+
+int TimeSeriesStore::rawWindow(int bucketSamples, Bucket *out) const
+{
+    // Buckets end on the same sample boundaries a tier would use, the newest may be partial
+    const int pending = static_cast<int>(m_added % static_cast<quint64>(bucketSamples));
+    const int complete = qMin((m_raw.size() - pending) / bucketSamples,
+                              PointsPerWindow - (pending > 0 ? 1 : 0));
+    const int used = complete * bucketSamples + pending;
+    const double *source = m_raw.end() - used;
+
+    int written = 0;
+    for (int start = 0; start < used; start += bucketSamples) {
+        const int end = qMin(start + bucketSamples, used);
+        Bucket bucket = {source[start], source[start], 0.0};
+        double sum = 0.0;
+        for (int i = start; i < end; ++i) {
+            bucket.min = qMin(bucket.min, source[i]);
+            bucket.max = qMax(bucket.max, source[i]);
+            sum += source[i];
+        }
+        bucket.avg = sum / (end - start);
+        out[written++] = bucket;
+    }
+    return written;
+}
+
+int TimeSeriesStore::window(Window window, Bucket *out) const
+{
+    if (fromRaw(window)) {
+        return rawWindow(bucketSeconds(window), out);
+    }
+
+    const Tier &tier = m_tiers[window];
+    const bool hasPending = tier.count > 0;
+    const int complete = qMin(tier.buckets.size(), PointsPerWindow - (hasPending ? 1 : 0));
+
+    // Newest completed buckets are at the end of the contiguous view
+    const Bucket *source = tier.buckets.end() - complete;
+    for (int i = 0; i < complete; ++i) {
+        out[i] = source[i];
+    }
+
+    if (hasPending) {
+        out[complete] = {tier.min, tier.max, tier.sum / tier.count};
+        return complete + 1;
+    }
+    return complete;
+}
+
+QString TimeSeriesStore::windowLabel(Window window)
+{
+    switch (window) {
+    case OneMinute:
+        return "60 seconds";
+    case FiveMinutes:
+        return "5 minutes";
+    case TenMinutes:
+        return "10 minutes";
+    case OneHour:
+        return "1 hour";
+    case OneDay:
+        return "24 hours";
+    default:
+        return QString();
+    }
+}
+
+int TimeSeriesStore::bucketSeconds(Window window)
+{
+    const int seconds[WindowCount] = {1, 5, 10, 60, 1440};
+    return seconds[window];
+}
@@ -0,0 +1,61 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include <QString>
+#include "RingBuffer.h"
+
+// In-memory history of one metric sampled once per tick. The newest minutes are kept at full
+// resolution, older data as min/max/avg rollups, so every view window is drawn from roughly the
+// same number of buckets no matter how much time it covers. Windows that fit in the raw history
+// are rolled up when read, so zooming out to a few minutes still sees every sample.
+class TimeSeriesStore
+{
+public:
+    enum Window { OneMinute, FiveMinutes, TenMinutes, OneHour, OneDay, WindowCount };
+
+    struct Bucket
+    {
+        double min;
+        double max;
+        double avg;
+    };
+
+    // Buckets drawn for every window
+    static constexpr int PointsPerWindow = 60;
+    // Raw samples kept, enough for the 10 minute window
+    static constexpr int RawSamples = 600;
+
+    TimeSeriesStore();
+
+    void add(double value);
+    void clear();
+
+    // Copies up to PointsPerWindow buckets for the window into out, oldest first, and returns how
+    // many were written. The newest one may be a partially filled bucket.
+    int window(Window window, Bucket *out) const;
+
+    static QString windowLabel(Window window);
+    static int bucketSeconds(Window window);
+
+private:
+    // True when the window is drawn from m_raw instead of a rollup tier
+    static bool fromRaw(Window window);
+    int rawWindow(int bucketSamples, Bucket *out) const;
+
+    struct Tier
+    {
+        int bucketSamples;          // ticks rolled into one bucket
+        RingBuffer<Bucket> buckets; // completed buckets
+        // Rollup in progress
+        double min;
+        double max;
+        double sum;
+        int count;
+    };
+
+    RingBuffer<double> m_raw;
+    quint64 m_added = 0; // samples since the last clear, aligns raw buckets with the tiers
+    Tier m_tiers[WindowCount]; // only used for windows longer than the raw history
+};
+
+#endif // TIMESERIESSTORE_H
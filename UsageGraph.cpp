@@ -1,5 +1,10 @@
 #include "UsageGraph.h"
+#include <QAction>
 #include <QApplication>
+#include <QContextMenuEvent>
+#include <QElapsedTimer>
+#include <QMenu>
+#include <QMouseEvent>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPalette>
@@ -20,11 +25,9 @@ UsageGraph::UsageGraph(QString title,
     , m_minValueLabel(std::move(minValueLabel))
     , m_maxValueLabel(std::move(maxValueLabel))
     , m_unit(std::move(unit))
-    , m_maxPoints(60)
+    , m_maxPoints(TimeSeriesStore::PointsPerWindow)
     , m_displayLabels(displayLabels)
 {
-    m_history.fill(0, m_maxPoints);
-    m_rawHistory.fill(minValue, m_maxPoints);
     m_accentColor = QApplication::palette().highlight().color();
     setMinimumHeight(displayLabels ? 180 : 40);
     setMinimumWidth(displayLabels ? 220 : 60);
@@ -48,69 +51,93 @@ UsageGraph::UsageGraph(QString title, double minValue, double maxValue, QString
 
 void UsageGraph::setTitle(const QString &title)
 {
+    if (title == m_title)
+        return;
     m_title = title;
-    update();
+    invalidateBackground();
 }
 
 void UsageGraph::setRange(double minValue, double maxValue)
 {
+    // history is stored raw and normalized while painting, so nothing to recompute here
     m_minValue = minValue;
     m_maxValue = maxValue;
-
-    // renormalizes history every time range is changed
-    m_history.clear();
-    for (double rawValue : m_rawHistory) {
-        double clamped = qBound(m_minValue, rawValue, m_maxValue);
-        double normalized = ((clamped - m_minValue) / (m_maxValue - m_minValue)) * 100.0;
-        m_history.append(normalized);
-    }
-
     update();
 }
 
 void UsageGraph::setRangeLabels(QString minValue, QString maxValue)
 {
+    if (minValue == m_minValueLabel && maxValue == m_maxValueLabel)
+        return;
     m_minValueLabel = std::move(minValue);
     m_maxValueLabel = std::move(maxValue);
-    update();
+    invalidateBackground();
 }
 
 void UsageGraph::setUnit(const QString &unit)
 {
+    // Callers set the unit every tick, only a real change rebuilds the cached background
+    if (unit == m_unit)
+        return;
     m_unit = unit;
-    update();
+    invalidateBackground();
 }
 
 void UsageGraph::addUtilizationValue(double value)
 {
-    if (m_rawHistory.size() >= m_maxPoints)
-        m_rawHistory.removeFirst();
-    m_rawHistory.append(value);
+    m_store.add(value);
+    update();
+}
 
-    value = qBound(m_minValue, value, m_maxValue);
-    double normalized = ((value - m_minValue) / (m_maxValue - m_minValue)) * 100.0;
+void UsageGraph::setWindow(TimeSeriesStore::Window window)
+{
+    if (window == m_window)
+        return;
+    m_window = window;
+    invalidateBackground();
+}
+
+void UsageGraph::setStackedSeries(const QStringList &names, const QVector<QColor> &colors)
+{
+    m_seriesNames = names;
+    m_seriesColors = colors;
+    m_seriesStores.clear();
+    for (int i = 0; i < names.size(); ++i) {
+        m_seriesStores.append(TimeSeriesStore());
+        if (m_seriesColors.size() <= i) {
+            m_seriesColors.append(m_accentColor);
+        }
+    }
+    invalidateBackground();
+}
 
-    if (m_history.size() >= m_maxPoints)
-        m_history.removeFirst();
-    m_history.append(normalized);
+void UsageGraph::addStackedValues(const QVector<double> &values)
+{
+    for (int i = 0; i < m_seriesStores.size(); ++i) {
+        m_seriesStores[i].add(i < values.size() ? values[i] : m_minValue);
+    }
     update();
 }
 
 void UsageGraph::setTextColor(const QColor &color){
+    if (color == m_textColor)
+        return;
     m_textColor = color;
-    update();
+    invalidateBackground();
 }
 
 QColor UsageGraph::getTextColor(){
     return m_textColor;
 }
 
-void UsageGraph::paintEvent(QPaintEvent *event)
+void UsageGraph::invalidateBackground()
 {
-    Q_UNUSED(event);
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    m_backgroundDirty = true;
+    update();
+}
 
+void UsageGraph::renderBackground()
+{
     int w = width();
     int h = height();
 
@@ -122,6 +149,20 @@ void UsageGraph::paintEvent(QPaintEvent *event)
 
     int graphHeight = h - (topPadding + bottomPadding);
     int graphWidth = w - (leftPadding + rightPadding);
+    m_graphRect = QRect(leftPadding, topPadding, graphWidth, graphHeight);
+
+    m_fillGradient = QLinearGradient(leftPadding, 0, w - rightPadding, 0);
+    m_fillGradient.setColorAt(0.0, QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 80));
+    m_fillGradient.setColorAt(1.0, QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 10));
+
+    const qreal ratio = devicePixelRatioF();
+    m_background = QPixmap(size() * ratio);
+    m_background.setDevicePixelRatio(ratio);
+    m_background.fill(Qt::transparent);
+    m_backgroundDirty = false;
+
+    QPainter painter(&m_background);
+    painter.setRenderHint(QPainter::Antialiasing);
 
     if (m_displayLabels) {
         QColor textColor = m_textColor;
@@ -134,6 +175,22 @@ void UsageGraph::paintEvent(QPaintEvent *event)
         QRect titleRect(leftPadding, 5, w - 70, titleHeight);
         painter.drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter, m_title);
 
+        // Legend for stacked bands, right after the title
+        if (isStacked()) {
+            int x = leftPadding + painter.fontMetrics().horizontalAdvance(m_title) + 16;
+            QFont legendFont = font();
+            legendFont.setPointSize(8);
+            painter.setFont(legendFont);
+            for (int i = 0; i < m_seriesNames.size(); ++i) {
+                painter.fillRect(x, 5 + titleHeight / 2 - 4, 8, 8, m_seriesColors[i]);
+                x += 12;
+                painter.drawText(QRect(x, 5, w, titleHeight),
+                                 Qt::AlignLeft | Qt::AlignVCenter,
+                                 m_seriesNames[i]);
+                x += painter.fontMetrics().horizontalAdvance(m_seriesNames[i]) + 10;
+            }
+        }
+
         QFont labelFont = font();
         labelFont.setPointSize(8);
         painter.setFont(labelFont);
@@ -143,16 +200,19 @@ void UsageGraph::paintEvent(QPaintEvent *event)
         painter.drawText(maxLabelRect, Qt::AlignRight | Qt::AlignVCenter, maxLabel);
 
         QRect timeRect(leftPadding, h - bottomPadding + 5, w - 70, 20);
-        painter.drawText(timeRect, Qt::AlignLeft | Qt::AlignVCenter, "60 seconds");
+        m_timeLabelRect = painter.boundingRect(timeRect,
+                                               Qt::AlignLeft | Qt::AlignVCenter,
+                                               TimeSeriesStore::windowLabel(m_window));
+        painter.drawText(timeRect,
+                         Qt::AlignLeft | Qt::AlignVCenter,
+                         TimeSeriesStore::windowLabel(m_window));
 
         QString minLabel = m_minValueLabel + m_unit;
         QRect minLabelRect(w - 65, h - bottomPadding + 5, 60, 20);
         painter.drawText(minLabelRect, Qt::AlignRight | Qt::AlignVCenter, minLabel);
-    }
 
-    double xStep = static_cast<double>(graphWidth) / (m_maxPoints - 1);
+        double xStep = static_cast<double>(graphWidth) / (m_maxPoints - 1);
 
-    if (m_displayLabels) {
         QPen gridPen(QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 30));
         gridPen.setWidth(0.5);
         gridPen.setStyle(Qt::SolidLine);
@@ -163,58 +223,194 @@ void UsageGraph::paintEvent(QPaintEvent *event)
             painter.drawLine(leftPadding, y, w - rightPadding, y);
         }
 
-        for (int i = 0; i <= m_maxPoints; i += 5) {
-            int x = static_cast<int>(leftPadding + i * xStep);
+        // 12 vertical divisions regardless of how many points are shown
+        for (int i = 0; i <= 12; i++) {
+            int x = static_cast<int>(leftPadding + i * (m_maxPoints - 1) / 12.0 * xStep);
             painter.drawLine(x, topPadding, x, h - bottomPadding);
         }
     }
 
-    if (!m_history.isEmpty()) {
-        QPainterPath path;
-        QPainterPath fillPath;
-
-        fillPath.moveTo(leftPadding, h - bottomPadding);
-        double initialX = leftPadding;
-        double initialY = topPadding + graphHeight - (m_history.first() * graphHeight / 100.0);
-        path.moveTo(initialX, initialY);
-        fillPath.lineTo(initialX, initialY);
-
-        for (int i = 1; i < m_history.size(); ++i) {
-            double x1 = leftPadding + (i - 1) * xStep;
-            double y1 = topPadding + graphHeight - (m_history.at(i - 1) * graphHeight / 100.0);
-            double x2 = leftPadding + i * xStep;
-            double y2 = topPadding + graphHeight - (m_history.at(i) * graphHeight / 100.0);
-            double cx = (x1 + x2) / 2;
-            double cy = (y1 + y2) / 2;
-            path.quadTo(x1, y1, cx, cy);
-            fillPath.quadTo(x1, y1, cx, cy);
+    QColor borderColor = QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 150);
+    QPen borderPen(borderColor);
+    borderPen.setWidth(1);
+    borderPen.setStyle(Qt::SolidLine);
+    painter.setPen(borderPen);
+    painter.drawRect(m_graphRect);
+}
+
+void UsageGraph::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    static const bool showFrameTimes = qEnvironmentVariableIsSet("SYSMON_FRAME_TIMES");
+
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+
+    if (m_backgroundDirty || m_background.deviceIndependentSize().toSize() != size())
+        renderBackground();
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_background);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    double xStep = static_cast<double>(m_graphRect.width()) / (m_maxPoints - 1);
+
+    if (isStacked()) {
+        paintStacked(painter, m_graphRect, xStep);
+    } else {
+        paintLine(painter, xStep);
+    }
+
+    m_lastFrameMs = frameTimer.nsecsElapsed() / 1.0e6;
+    m_averageFrameMs = m_averageFrameMs == 0.0 ? m_lastFrameMs
+                                               : m_averageFrameMs * 0.9 + m_lastFrameMs * 0.1;
+
+    if (showFrameTimes) {
+        QFont overlayFont = font();
+        overlayFont.setPointSize(7);
+        painter.setFont(overlayFont);
+        painter.setPen(m_textColor);
+        painter.drawText(m_graphRect.adjusted(0, 2, -4, 0),
+                         Qt::AlignRight | Qt::AlignTop,
+                         QString("%1 ms").arg(m_averageFrameMs, 0, 'f', 3));
+    }
+}
+
+double UsageGraph::toGraphY(double value) const
+{
+    value = qBound(m_minValue, value, m_maxValue);
+    const double normalized = (value - m_minValue) / (m_maxValue - m_minValue);
+    return m_graphRect.top() + m_graphRect.height() - normalized * m_graphRect.height();
+}
+
+void UsageGraph::paintLine(QPainter &painter, double xStep)
+{
+    const int count = m_store.window(m_window, m_buckets);
+    if (count == 0)
+        return;
+
+    // Newest bucket sits on the right edge, a young history only covers part of the width
+    const double left = m_graphRect.left() + (m_maxPoints - count) * xStep;
+    const double bottom = m_graphRect.top() + m_graphRect.height();
+
+    // Rolled-up windows get a min/max envelope behind the average line
+    if (m_window != TimeSeriesStore::OneMinute) {
+        QPolygonF envelope;
+        envelope.reserve(count * 2);
+        for (int i = 0; i < count; ++i)
+            envelope.append(QPointF(left + i * xStep, toGraphY(m_buckets[i].max)));
+        for (int i = count - 1; i >= 0; --i)
+            envelope.append(QPointF(left + i * xStep, toGraphY(m_buckets[i].min)));
+
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 60));
+        painter.drawPolygon(envelope);
+        painter.setBrush(Qt::NoBrush);
+    }
+
+    // Paths are members so their element storage is reused between frames
+    m_linePath.clear();
+    m_fillPath.clear();
+
+    m_fillPath.moveTo(left, bottom);
+    double initialY = toGraphY(m_buckets[0].avg);
+    m_linePath.moveTo(left, initialY);
+    m_fillPath.lineTo(left, initialY);
+
+    for (int i = 1; i < count; ++i) {
+        double x1 = left + (i - 1) * xStep;
+        double y1 = toGraphY(m_buckets[i - 1].avg);
+        double x2 = left + i * xStep;
+        double y2 = toGraphY(m_buckets[i].avg);
+        double cx = (x1 + x2) / 2;
+        double cy = (y1 + y2) / 2;
+        m_linePath.quadTo(x1, y1, cx, cy);
+        m_fillPath.quadTo(x1, y1, cx, cy);
+    }
+
+    m_fillPath.lineTo(left + static_cast<double>(count - 1) * xStep, bottom);
+    m_fillPath.lineTo(left, bottom);
+
+    painter.fillPath(m_fillPath, m_fillGradient);
+
+    QPen linePen(m_textColor);
+    linePen.setWidth(2);
+    painter.setPen(linePen);
+    painter.drawPath(m_linePath);
+}
+
+void UsageGraph::paintStacked(QPainter &painter, const QRect &graphRect, double xStep)
+{
+    const double range = m_maxValue - m_minValue;
+    if (range <= 0.0) {
+        return;
+    }
+
+    // Running top edge of the stack, starts at the baseline. The scratch buffers are members
+    // like the line paths, resize() keeps their capacity between frames
+    const int points = m_maxPoints;
+    m_stackLower.resize(points);
+    m_stackLower.fill(0.0);
+    m_stackUpper.resize(points);
+
+    auto yFor = [&](double stacked) {
+        const double normalized = qBound(0.0, stacked / range, 1.0);
+        return graphRect.top() + graphRect.height() - normalized * graphRect.height();
+    };
+
+    for (int band = 0; band < m_seriesStores.size(); ++band) {
+        // Bands stack their per-bucket averages
+        const int count = m_seriesStores[band].window(m_window, m_buckets);
+        const int offset = points - count;
+
+        m_bandPolygon.clear();
+        m_bandPolygon.reserve(points * 2);
+        for (int i = 0; i < points; ++i) {
+            const double value = i >= offset ? m_buckets[i - offset].avg : m_minValue;
+            m_stackUpper[i] = m_stackLower[i] + qMax(0.0, value - m_minValue);
+            m_bandPolygon.append(QPointF(graphRect.left() + i * xStep, yFor(m_stackUpper[i])));
+        }
+        for (int i = points - 1; i >= 0; --i) {
+            m_bandPolygon.append(QPointF(graphRect.left() + i * xStep, yFor(m_stackLower[i])));
         }
 
-        fillPath.lineTo(leftPadding + static_cast<double>(m_history.size() - 1) * xStep,
-                        h - bottomPadding);
-        fillPath.lineTo(leftPadding, h - bottomPadding);
-
-        QLinearGradient gradient(leftPadding, 0, w - rightPadding, 0);
-        gradient.setColorAt(0.0, QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 80));
-        gradient.setColorAt(1.0, QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 10));
-        painter.fillPath(fillPath, gradient);
-
-        QPen linePen(m_textColor);
-        linePen.setWidth(2);
-        painter.setPen(linePen);
-        painter.drawPath(path);
-
-        QColor borderColor = QColor(m_textColor.red(), m_textColor.green(), m_textColor.blue(), 150);
-        QPen borderPen(borderColor);
-        borderPen.setWidth(1);
-        borderPen.setStyle(Qt::SolidLine);
-        painter.setPen(borderPen);
-        painter.drawRect(leftPadding, topPadding, graphWidth, graphHeight);
+        QColor fill = m_seriesColors[band];
+        fill.setAlpha(170);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(fill);
+        painter.drawPolygon(m_bandPolygon);
+
+        m_stackLower.swap(m_stackUpper);
     }
+
+    painter.setBrush(Qt::NoBrush);
 }
 
 void UsageGraph::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
-    update();
+    invalidateBackground();
+}
+
+void UsageGraph::mousePressEvent(QMouseEvent *event)
+{
+    // Clicking the time label steps through the windows
+    if (event->button() == Qt::LeftButton && m_timeLabelRect.contains(event->pos())) {
+        setWindow(static_cast<TimeSeriesStore::Window>((m_window + 1) % TimeSeriesStore::WindowCount));
+        return;
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void UsageGraph::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    for (int i = 0; i < TimeSeriesStore::WindowCount; ++i) {
+        const TimeSeriesStore::Window window = static_cast<TimeSeriesStore::Window>(i);
+        QAction *action = menu.addAction(TimeSeriesStore::windowLabel(window));
+        action->setCheckable(true);
+        action->setChecked(window == m_window);
+        connect(action, &QAction::triggered, this, [this, window]() { setWindow(window); });
+    }
+    menu.exec(event->globalPos());
 }
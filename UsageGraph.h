@@ -2,9 +2,15 @@
 #define USAGEGRAPH_H
 
 #include <QColor>
+#include <QLinearGradient>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QPolygonF>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <QWidget>
+#include "TimeSeriesStore.h"
 
 class UsageGraph : public QWidget
 {
@@ -36,12 +42,34 @@ public:
     void setRangeLabels(QString minValue, QString maxValue);
     void setUnit(const QString &unit);
     void addUtilizationValue(double value);
+
+    // Time span shown; clicking the time label or the context menu switches it too
+    void setWindow(TimeSeriesStore::Window window);
+    TimeSeriesStore::Window window() const { return m_window; }
+
+    // Stacked-area mode: one band per series, drawn on top of each other in the given order
+    void setStackedSeries(const QStringList &names, const QVector<QColor> &colors);
+    void addStackedValues(const QVector<double> &values);
+    bool isStacked() const { return !m_seriesNames.isEmpty(); }
     void setTextColor(const QColor &color);
     QColor getTextColor();
 
+    // Paint cost of this graph, set SYSMON_FRAME_TIMES=1 to draw it in the corner
+    double lastFrameTimeMs() const { return m_lastFrameMs; }
+    double averageFrameTimeMs() const { return m_averageFrameMs; }
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    void invalidateBackground();
+    void renderBackground();
+    double toGraphY(double value) const;
+    void paintLine(QPainter &painter, double xStep);
+    void paintStacked(QPainter &painter, const QRect &graphRect, double xStep);
 
 private:
     QString m_title;
@@ -52,10 +80,30 @@ private:
     QString m_unit;
     int m_maxPoints;
     bool m_displayLabels;
-    QVector<double> m_history;
-    QVector<double> m_rawHistory;
+    TimeSeriesStore m_store; // values as added, normalized against the range when painting
+    TimeSeriesStore::Window m_window = TimeSeriesStore::OneMinute;
+    TimeSeriesStore::Bucket m_buckets[TimeSeriesStore::PointsPerWindow]; // paint scratch
+    QStringList m_seriesNames;
+    QVector<QColor> m_seriesColors;
+    QVector<TimeSeriesStore> m_seriesStores; // one per band
     QColor m_accentColor;
     QColor m_textColor = QColor(255, 255, 255);
+
+    // Title, labels, grid and border only change on resize/color/label changes, so they are
+    // rendered once into m_background and blitted; only the data is drawn every frame
+    QPixmap m_background;
+    bool m_backgroundDirty = true;
+    QRect m_graphRect;
+    QRect m_timeLabelRect;
+    QLinearGradient m_fillGradient;
+    QPainterPath m_linePath;
+    QPainterPath m_fillPath;
+    QVector<double> m_stackLower; // paintStacked scratch
+    QVector<double> m_stackUpper;
+    QPolygonF m_bandPolygon;
+
+    double m_lastFrameMs = 0.0;
+    double m_averageFrameMs = 0.0;
 };
 
 #endif // USAGEGRAPH_H
@@ -1,5 +1,6 @@
 #include <QApplication>
 #include "MainWindow.h"
+#include "SamplerThread.h"
 
 int main(int argc, char *argv[])
 {
@@ -8,6 +9,8 @@ int main(int argc, char *argv[])
     app.setApplicationDisplayName("Real-Time-System-Monitor");
     app.setDesktopFileName("Real-Time-System-Monitor");
 
+    // Must outlive the window so collectors stop after the widgets they feed are gone
+    SamplerThread sampler;
 
     MainWindow window;
     window.setWindowTitle("Real-Time-System-Monitor");